@@ -0,0 +1,397 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "Analysis.h"
+#include "Simulation.h"
+#include "UI.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace Game2048 {
+
+	namespace {
+
+		const char DirectionLetters[] = "urdl";
+
+		std::size_t GetDirectionIndex(const Direction direction) {
+			return std::find(std::begin(Directions), std::end(Directions), direction) - std::begin(Directions);
+		}
+
+		/// <summary>
+		/// Final score of game played by policy after given move and spawn of seeded generator
+		/// </summary>
+		double PlayOut(const Game &game, const Direction move, const uint64_t seed, const std::string &policyName) {
+
+			Game rollout = game;
+			rollout.Seed(seed);
+			rollout.MoveBoard(move);
+			rollout.AddRandomTile();
+
+			auto policy = CreatePolicy(policyName, GetPolicySeed(seed));
+
+			return SimulateGame(rollout, *policy).Score;
+		}
+
+	}
+
+	AnalysisReport AnalyzePosition(const Game &game, const AnalysisConfig &config) {
+
+		auto start = std::chrono::steady_clock::now();
+
+		AnalysisReport report;
+		report.Position = game.GetPosition();
+
+		for( Direction direction : Directions ) {
+
+			if( !(game.GetLegalMoves() & DirectionMask(direction)) ) continue;
+
+			Game moved = game;
+
+			MoveAnalysis analysis;
+			analysis.Move = direction;
+			analysis.ScoreDelta = moved.MoveBoard(direction).ScoreDelta;
+
+			report.Moves.push_back(analysis);
+
+		}
+
+		// task 0 of every move is its search, others are rollouts
+		uint64_t tasksPerMove = config.Rollouts + 1;
+		uint64_t totalTasks = tasksPerMove * report.Moves.size();
+		std::atomic<uint64_t> nextTask = 0;
+
+		std::vector<std::vector<double>> finalScores(report.Moves.size(), std::vector<double>(config.Rollouts));
+
+		SearchConfig searchConfig;
+		searchConfig.MaxDepth = config.SearchDepth;
+		searchConfig.TimeBudget = std::chrono::hours(24);
+		searchConfig.UseCache = true;
+
+		std::vector<std::thread> threads;
+
+		for( unsigned t = 0; t < std::max(1u, config.Threads); t++ ) {
+
+			threads.emplace_back([&]() {
+
+				ExpectimaxSearch search(GetDefaultEvaluator(), searchConfig);
+
+				uint64_t i;
+				while( (i = nextTask.fetch_add(1)) < totalTasks ) {
+
+					MoveAnalysis &analysis = report.Moves[i / tasksPerMove];
+					uint64_t task = i % tasksPerMove;
+
+					if( task == 0 ) {
+						SearchResult result = search.SearchMove(game, analysis.Move);
+						analysis.SearchValue = result.Value;
+						analysis.ArenaHighWater = result.ArenaHighWater;
+						continue;
+					}
+
+					// every slot is written by one thread only
+					finalScores[i / tasksPerMove][task - 1] = PlayOut(game, analysis.Move, config.Seed + task - 1, config.Policy);
+
+				}
+
+			});
+
+		}
+
+		for( std::thread &thread : threads ) {
+			thread.join();
+		}
+
+		for( std::size_t move = 0; move < report.Moves.size(); move++ ) {
+			report.Moves[move].FinalScore = GetInterval(finalScores[move]);
+		}
+
+		std::stable_sort(report.Moves.begin(), report.Moves.end(), [](const MoveAnalysis &first, const MoveAnalysis &second) {
+			return first.FinalScore.Mean > second.FinalScore.Mean;
+		});
+
+		report.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return report;
+	}
+
+	void WriteAnalysisReport(std::ostream &stream, const AnalysisReport &report) {
+
+		char line[256];
+
+		snprintf(line, sizeof(line), "Position %s, %.2f s\n\n", report.Position.c_str(), report.Seconds);
+		stream << line;
+
+		if( report.Moves.empty() ) {
+			stream << "No legal move, game is over\n";
+			return;
+		}
+
+		snprintf(line, sizeof(line), "%-5s %8s %14s %10s %14s %25s\n", "move", "gain", "search value", "arena KiB", "final score", "95% interval");
+		stream << line;
+
+		for( const MoveAnalysis &analysis : report.Moves ) {
+
+			snprintf(line, sizeof(line), "%-5s %8u %14.1f %10.1f %14.1f   [%10.1f, %10.1f]\n", GetDirectionArrow(analysis.Move).c_str(),
+				analysis.ScoreDelta, analysis.SearchValue, analysis.ArenaHighWater / 1024.0, analysis.FinalScore.Mean, analysis.FinalScore.Low, analysis.FinalScore.High);
+			stream << line;
+
+		}
+
+	}
+
+	bool SaveGameRecord(const std::string &file, const GameRecord &record) {
+
+		std::ofstream stream(file, std::ofstream::out | std::ofstream::trunc);
+		if( !stream.is_open() ) return false;
+
+		for( std::size_t i = 0; i < record.Positions.size(); i++ ) {
+
+			stream << record.Positions[i];
+			if( i < record.Moves.size() ) stream << ' ' << DirectionLetters[GetDirectionIndex(record.Moves[i])];
+			stream << '\n';
+
+		}
+
+		return stream.good();
+	}
+
+	bool LoadGameRecord(const std::string &file, GameRecord &record) {
+
+		std::ifstream stream(file);
+		if( !stream.is_open() ) return false;
+
+		GameRecord loaded;
+		Game game;
+
+		std::string line;
+		bool finished = false;
+
+		while( std::getline(stream, line) ) {
+
+			if( line.empty() ) continue;
+
+			// only last position is without move
+			if( finished ) return false;
+
+			std::istringstream lineStream(line);
+
+			std::string position, move;
+			lineStream >> position >> move;
+
+			if( !game.SetPosition(position) ) return false;
+
+			loaded.Positions.push_back(position);
+
+			if( move.empty() ) {
+				finished = true;
+				continue;
+			}
+
+			const char *letter = move.size() == 1 ? std::strchr(DirectionLetters, move[0]) : nullptr;
+			if( !letter || !*letter ) return false;
+
+			Direction direction = Directions[letter - DirectionLetters];
+			if( !(game.GetLegalMoves() & DirectionMask(direction)) ) return false;
+
+			loaded.Moves.push_back(direction);
+
+		}
+
+		if( loaded.Positions.empty() ) return false;
+
+		record = std::move(loaded);
+
+		return true;
+	}
+
+	GameRecord RecordGame(Game &game, Policy &policy) {
+
+		GameRecord record;
+
+		while( game.GetLegalMoves() != 0 ) {
+
+			Direction move = policy.ChooseMove(game);
+
+			record.Positions.push_back(game.GetPosition());
+			record.Moves.push_back(move);
+
+			game.MoveBoard(move);
+			game.AddRandomTile();
+
+		}
+
+		record.Positions.push_back(game.GetPosition());
+
+		return record;
+	}
+
+	RegretReport AnalyzeGame(const GameRecord &record, const RegretConfig &config, const std::atomic<bool> *cancel) {
+
+		auto start = std::chrono::steady_clock::now();
+
+		struct MoveTask {
+			std::size_t Position;
+			Direction Move;
+		};
+
+		std::vector<Game> positions;
+		std::vector<MoveTask> tasks;
+
+		RegretReport report;
+
+		for( std::size_t i = 0; i < record.Moves.size(); i++ ) {
+
+			Game game;
+			game.SetPosition(record.Positions[i]);
+
+			MoveRegret regret;
+			regret.Index = i;
+			regret.Played = regret.Best = record.Moves[i];
+
+			report.Moves.push_back(regret);
+
+			// forced move costs nothing
+			if( std::popcount(game.GetLegalMoves()) > 1 ) {
+				for( Direction direction : Directions ) {
+					if( game.GetLegalMoves() & DirectionMask(direction) ) tasks.push_back({ i, direction });
+				}
+			}
+
+			positions.push_back(game);
+
+		}
+
+		// mean final score of every position and direction, tasks of one position write different slots
+		std::vector<std::array<double, 4>> scores(positions.size());
+		std::atomic<std::size_t> nextTask = 0;
+
+		std::vector<std::thread> threads;
+
+		for( unsigned t = 0; t < std::max(1u, config.Threads); t++ ) {
+
+			threads.emplace_back([&]() {
+
+				std::size_t i;
+				while( (i = nextTask.fetch_add(1)) < tasks.size() ) {
+
+					if( cancel && cancel->load(std::memory_order_relaxed) ) break;
+
+					const MoveTask &task = tasks[i];
+
+					double sum = 0;
+					for( uint64_t r = 0; r < config.Rollouts; r++ ) {
+						sum += PlayOut(positions[task.Position], task.Move, config.Seed + r, config.Policy);
+					}
+
+					scores[task.Position][GetDirectionIndex(task.Move)] = sum / std::max<uint64_t>(1, config.Rollouts);
+
+				}
+
+			});
+
+		}
+
+		for( std::thread &thread : threads ) {
+			thread.join();
+		}
+
+		report.Complete = !cancel || !cancel->load();
+
+		for( std::size_t i = 0; i < tasks.size(); i++ ) {
+
+			const MoveTask &task = tasks[i];
+			MoveRegret &regret = report.Moves[task.Position];
+
+			double score = scores[task.Position][GetDirectionIndex(task.Move)];
+
+			if( task.Move == regret.Played ) regret.PlayedScore = score;
+
+			// first of equal moves in order of Directions is best
+			bool first = i == 0 || tasks[i - 1].Position != task.Position;
+
+			if( first || score > regret.BestScore ) {
+				regret.Best = task.Move;
+				regret.BestScore = score;
+			}
+
+		}
+
+		for( MoveRegret &regret : report.Moves ) {
+
+			regret.Regret = regret.BestScore - regret.PlayedScore;
+			report.TotalRegret += regret.Regret;
+
+		}
+
+		report.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return report;
+	}
+
+	std::vector<MoveRegret> GetBlunders(const RegretReport &report, const std::size_t count) {
+
+		std::vector<MoveRegret> blunders;
+
+		for( const MoveRegret &regret : report.Moves ) {
+			if( regret.Regret > 0 ) blunders.push_back(regret);
+		}
+
+		// earlier move goes first among equal regrets
+		std::stable_sort(blunders.begin(), blunders.end(), [](const MoveRegret &first, const MoveRegret &second) {
+			return first.Regret > second.Regret;
+		});
+
+		if( blunders.size() > count ) blunders.resize(count);
+
+		return blunders;
+	}
+
+	void WriteRegretReport(std::ostream &stream, const RegretReport &report, const std::size_t blunders) {
+
+		char line[256];
+
+		std::size_t mistakes = std::count_if(report.Moves.begin(), report.Moves.end(), [](const MoveRegret &regret) {
+			return regret.Regret > 0;
+		});
+
+		snprintf(line, sizeof(line), "%zu moves, %zu not best, total regret %.1f, mean regret %.2f per move, %.2f s%s\n\n",
+			report.Moves.size(), mistakes, report.TotalRegret, report.Moves.empty() ? 0 : report.TotalRegret / report.Moves.size(),
+			report.Seconds, report.Complete ? "" : " (cancelled)");
+		stream << line;
+
+		snprintf(line, sizeof(line), "%6s %6s %6s %14s %14s %10s\n", "move", "played", "best", "played score", "best score", "regret");
+		stream << line;
+
+		for( const MoveRegret &regret : GetBlunders(report, blunders) ) {
+
+			snprintf(line, sizeof(line), "%6zu %6s %6s %14.1f %14.1f %10.1f\n", regret.Index + 1, GetDirectionArrow(regret.Played).c_str(),
+				GetDirectionArrow(regret.Best).c_str(), regret.PlayedScore, regret.BestScore, regret.Regret);
+			stream << line;
+
+		}
+
+	}
+
+	void WriteRegretCsv(std::ostream &stream, const RegretReport &report) {
+
+		stream << "move,played,best,played_score,best_score,regret\n";
+
+		for( const MoveRegret &regret : report.Moves ) {
+
+			stream << regret.Index + 1 << ',' << DirectionLetters[GetDirectionIndex(regret.Played)] << ','
+				<< DirectionLetters[GetDirectionIndex(regret.Best)] << ',' << regret.PlayedScore << ','
+				<< regret.BestScore << ',' << regret.Regret << '\n';
+
+		}
+
+	}
+
+}
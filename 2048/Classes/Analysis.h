@@ -0,0 +1,189 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Game.h"
+#include "Policy.h"
+#include "Tournament.h"
+
+namespace Game2048 {
+
+	// Interactive game records every finished game here
+	const std::string LastGameFile = "lastgame.txt";
+
+	/// <summary>
+	/// Evaluation of every legal move of single position
+	/// </summary>
+	struct AnalysisConfig {
+
+		// Expectimax searches every move exactly to this depth
+		int SearchDepth = 3;
+
+		// Games played to the end after every move
+		uint64_t Rollouts = 100;
+
+		// Policy from PolicyNames playing rollouts
+		std::string Policy = "greedy";
+
+		unsigned Threads = 1;
+
+		// Rollout r of every move spawns with seed Seed + r, so moves are compared on the same seeds
+		uint64_t Seed = 0;
+
+	};
+
+	struct MoveAnalysis {
+
+		Direction Move = UP;
+
+		// Score gained by move itself
+		uint32_t ScoreDelta = 0;
+
+		// Expectimax value after move
+		double SearchValue = 0;
+
+		// Most bytes of search nodes allocated at once
+		std::size_t ArenaHighWater = 0;
+
+		// Final score of rollouts started by move
+		Interval FinalScore;
+
+	};
+
+	struct AnalysisReport {
+
+		std::string Position;
+
+		// Legal moves sorted from best mean final score
+		std::vector<MoveAnalysis> Moves;
+
+		double Seconds = 0;
+
+	};
+
+	/// <summary>
+	/// Searches and plays out every legal move of game across threads
+	/// </summary>
+	/// <param name="game">position to analyze, game over position gives no moves</param>
+	/// <param name="config"></param>
+	/// <returns></returns>
+	AnalysisReport AnalyzePosition(const Game &game, const AnalysisConfig &config);
+
+	/// <summary>
+	/// Writes table of analyzed moves as text
+	/// </summary>
+	void WriteAnalysisReport(std::ostream &stream, const AnalysisReport &report);
+
+	/// <summary>
+	/// Positions of played game with move played in every position except last
+	/// </summary>
+	struct GameRecord {
+
+		// Text positions of EncodePosition
+		std::vector<std::string> Positions;
+
+		std::vector<Direction> Moves;
+
+	};
+
+	/// <summary>
+	/// Writes record as text, one position per line followed by letter of played move (u, r, d, l)
+	/// </summary>
+	/// <returns>false if file cannot be written</returns>
+	bool SaveGameRecord(const std::string &file, const GameRecord &record);
+
+	/// <summary>
+	/// Reads record of SaveGameRecord
+	/// </summary>
+	/// <returns>false for missing file, malformed position or illegal move</returns>
+	bool LoadGameRecord(const std::string &file, GameRecord &record);
+
+	/// <summary>
+	/// Plays already started game with given policy until no move is possible and records it
+	/// </summary>
+	GameRecord RecordGame(Game &game, Policy &policy);
+
+	/// <summary>
+	/// Regret analysis of whole game
+	/// </summary>
+	struct RegretConfig {
+
+		// Games played to the end after every legal move of every position
+		uint64_t Rollouts = 20;
+
+		// Policy from PolicyNames playing rollouts
+		std::string Policy = "greedy";
+
+		unsigned Threads = 1;
+
+		// Rollout r of every move spawns with seed Seed + r
+		uint64_t Seed = 0;
+
+	};
+
+	struct MoveRegret {
+
+		// Position of move in record
+		std::size_t Index = 0;
+
+		Direction Played = UP;
+		Direction Best = UP;
+
+		// Mean final score of rollouts after played and best move
+		double PlayedScore = 0;
+		double BestScore = 0;
+
+		// Expected final score lost by played move, 0 for best move
+		double Regret = 0;
+
+	};
+
+	struct RegretReport {
+
+		// Every move of record in order of game
+		std::vector<MoveRegret> Moves;
+
+		double TotalRegret = 0;
+
+		double Seconds = 0;
+
+		// Analysis was not cancelled
+		bool Complete = true;
+
+	};
+
+	/// <summary>
+	/// Plays out every legal move of every position of record across threads. Positions with single
+	/// legal move have no regret and are skipped.
+	/// </summary>
+	/// <param name="record"></param>
+	/// <param name="config"></param>
+	/// <param name="cancel">stops analysis when set, report is not complete then</param>
+	/// <returns></returns>
+	RegretReport AnalyzeGame(const GameRecord &record, const RegretConfig &config, const std::atomic<bool> *cancel = nullptr);
+
+	/// <summary>
+	/// Moves with biggest regret, moves without regret are left out
+	/// </summary>
+	/// <param name="report"></param>
+	/// <param name="count">maximal number of moves</param>
+	/// <returns></returns>
+	std::vector<MoveRegret> GetBlunders(const RegretReport &report, const std::size_t count);
+
+	/// <summary>
+	/// Writes summary and top blunders as text
+	/// </summary>
+	void WriteRegretReport(std::ostream &stream, const RegretReport &report, const std::size_t blunders);
+
+	/// <summary>
+	/// Writes regret of every move as CSV
+	/// </summary>
+	void WriteRegretCsv(std::ostream &stream, const RegretReport &report);
+
+}
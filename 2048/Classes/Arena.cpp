@@ -0,0 +1,95 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Game2048 {
+
+	Arena::Arena(const std::size_t chunkSize) : ChunkSize(chunkSize) {}
+
+	void *Arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+
+		while( true ) {
+
+			while( CurrentChunk < Chunks.size() ) {
+
+				Chunk &chunk = Chunks[CurrentChunk];
+
+				// chunk itself is aligned only for new, so address is aligned instead of offset
+				uintptr_t base = reinterpret_cast<uintptr_t>(chunk.Memory.get());
+				std::size_t start = ((base + Offset + alignment - 1) & ~uintptr_t(alignment - 1)) - base;
+
+				if( start + bytes <= chunk.Size ) {
+
+					Used += start + bytes - Offset;
+					HighWater = std::max(HighWater, Used);
+					Offset = start + bytes;
+
+					return chunk.Memory.get() + start;
+				}
+
+				// rest of chunk stays unused until rewind
+				Used += chunk.Size - Offset;
+				CurrentChunk++;
+				Offset = 0;
+
+			}
+
+			// all chunks are full, big allocations get chunk of their own with room for alignment
+			std::size_t size = std::max(ChunkSize, bytes + alignment);
+
+			Chunks.push_back({ std::make_unique<std::byte[]>(size), size });
+
+		}
+
+	}
+
+	void Arena::do_deallocate(void *, std::size_t, std::size_t) {}
+	bool Arena::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+		return this == &other;
+	}
+
+	Arena::Mark Arena::GetMark() const {
+		return { CurrentChunk, Offset, Used };
+	}
+
+	void Arena::Rewind(const Mark &mark) {
+
+		CurrentChunk = mark.Chunk;
+		Offset = mark.Offset;
+		Used = mark.Used;
+
+	}
+
+	void Arena::Reset() {
+		Rewind(Mark());
+	}
+
+	std::size_t Arena::GetUsed() const {
+		return this->Used;
+	}
+
+	std::size_t Arena::GetHighWater() const {
+		return this->HighWater;
+	}
+
+	void Arena::ResetHighWater() {
+		HighWater = Used;
+	}
+
+	ArenaScope::ArenaScope(Arena &arena) : ScopeArena(arena), ScopeMark(arena.GetMark()) {}
+
+	ArenaScope::~ArenaScope() {
+		ScopeArena.Rewind(ScopeMark);
+	}
+
+	Arena &GetThreadArena() {
+
+		thread_local Arena arena;
+		return arena;
+
+	}
+
+}
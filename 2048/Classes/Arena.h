@@ -0,0 +1,109 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace Game2048 {
+
+	/// <summary>
+	/// Bump allocator for search and analysis nodes. Memory is handed out from big chunks and is
+	/// never freed one by one, Rewind returns everything allocated after mark and Reset returns all.
+	/// Chunks are kept for next use, so arena reused move after move stops calling malloc.
+	/// Arena is not thread safe, every thread uses its own from GetThreadArena.
+	/// </summary>
+	class Arena : public std::pmr::memory_resource {
+
+	public:
+
+		/// <summary>
+		/// Position in arena to rewind to
+		/// </summary>
+		struct Mark {
+			std::size_t Chunk = 0;
+			std::size_t Offset = 0;
+			std::size_t Used = 0;
+		};
+
+		Arena(const std::size_t chunkSize = 1 << 20);
+
+		Arena(const Arena &) = delete;
+		Arena &operator=(const Arena &) = delete;
+
+		Mark GetMark() const;
+
+		/// <summary>
+		/// Frees everything allocated after mark was taken
+		/// </summary>
+		void Rewind(const Mark &mark);
+
+		/// <summary>
+		/// Frees everything, chunks stay reserved
+		/// </summary>
+		void Reset();
+
+		// Bytes currently allocated
+		std::size_t GetUsed() const;
+
+		// Most bytes allocated at once since creation or ResetHighWater
+		std::size_t GetHighWater() const;
+
+		void ResetHighWater();
+
+	protected:
+
+		void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+		// memory is returned by Rewind or Reset
+		void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override;
+
+		bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+	private:
+
+		struct Chunk {
+			std::unique_ptr<std::byte[]> Memory;
+			std::size_t Size;
+		};
+
+		std::size_t ChunkSize;
+		std::vector<Chunk> Chunks;
+
+		// Chunk used for next allocation and first free byte in it
+		std::size_t CurrentChunk = 0;
+		std::size_t Offset = 0;
+
+		std::size_t Used = 0;
+		std::size_t HighWater = 0;
+
+	};
+
+	/// <summary>
+	/// Rewinds arena to state from construction when leaving scope
+	/// </summary>
+	class ArenaScope {
+
+	public:
+
+		ArenaScope(Arena &arena);
+		~ArenaScope();
+
+		ArenaScope(const ArenaScope &) = delete;
+		ArenaScope &operator=(const ArenaScope &) = delete;
+
+	private:
+
+		Arena &ScopeArena;
+		Arena::Mark ScopeMark;
+
+	};
+
+	/// <summary>
+	/// Arena of calling thread
+	/// </summary>
+	Arena &GetThreadArena();
+
+}
@@ -0,0 +1,807 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "Commands.h"
+#include "Analysis.h"
+#include "Corpus.h"
+#include "CrossCheck.h"
+#include "LiveFeed.h"
+#include "OpeningBook.h"
+#include "PackedBoard.h"
+#include "Perft.h"
+#include "PositionCodec.h"
+#include "Renderer.h"
+#include "SearchCache.h"
+#include "Sharding.h"
+#include "Simulation.h"
+#include "Tournament.h"
+#include "UI.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace Game2048 {
+
+	namespace {
+
+		using Options = std::map<std::string, std::string>;
+
+		/// <summary>
+		/// Parses "--name value" pairs following command name
+		/// </summary>
+		Options ParseOptions(const int argc, const char **argv) {
+
+			Options options;
+
+			for( int i = 2; i < argc; i += 2 ) {
+
+				std::string name = argv[i];
+
+				if( name.rfind("--", 0) != 0 || i + 1 >= argc ) {
+					throw std::invalid_argument("expected --option value, got " + name);
+				}
+
+				options[name.substr(2)] = argv[i + 1];
+
+			}
+
+			return options;
+		}
+
+		std::string GetOption(const Options &options, const std::string &name, const std::string &defaultValue) {
+
+			auto option = options.find(name);
+			return option != options.end() ? option->second : defaultValue;
+
+		}
+
+		uint64_t GetNumberOption(const Options &options, const std::string &name, const uint64_t defaultValue) {
+
+			auto option = options.find(name);
+			return option != options.end() ? std::stoull(option->second) : defaultValue;
+
+		}
+
+		double GetProbabilityOption(const Options &options, const std::string &name, const double defaultValue) {
+
+			auto option = options.find(name);
+			if( option == options.end() ) return defaultValue;
+
+			double probability = std::stod(option->second);
+			if( !(probability >= 0 && probability <= 1) ) {
+				throw std::invalid_argument(name + " has to be between 0 and 1");
+			}
+
+			return probability;
+		}
+
+		std::vector<std::string> SplitList(const std::string &list) {
+
+			std::vector<std::string> items;
+			std::stringstream stream(list);
+
+			std::string item;
+			while( std::getline(stream, item, ',') ) {
+				if( !item.empty() ) items.push_back(item);
+			}
+
+			return items;
+		}
+
+		std::vector<int8_t> GetBoardSizesOption(const Options &options, const std::string &defaultValue) {
+
+			std::vector<int8_t> boardSizes;
+
+			for( const std::string &item : SplitList(GetOption(options, "sizes", defaultValue)) ) {
+
+				int boardSize = std::stoi(item);
+
+				if( boardSize < MinBoardSize || boardSize > MaxBoardSize ) {
+					throw std::invalid_argument("unsupported board size " + item);
+				}
+
+				boardSizes.push_back(boardSize);
+
+			}
+
+			return boardSizes;
+		}
+
+		std::vector<std::string> GetPoliciesOption(const Options &options, const std::string &defaultValue) {
+
+			std::vector<std::string> policies = SplitList(GetOption(options, "policies", defaultValue));
+
+			// names may carry parameter, policy is created to validate it
+			for( const std::string &policy : policies ) {
+				if( !CreatePolicy(policy, 0) ) {
+					throw std::invalid_argument("unknown policy " + policy);
+				}
+			}
+
+			return policies;
+		}
+
+		unsigned GetThreadsOption(const Options &options) {
+			return GetNumberOption(options, "threads", std::max(1u, std::thread::hardware_concurrency()));
+		}
+
+		/// <summary>
+		/// CPU sets separated by colon, every set is comma list of CPUs and ranges, e.g. 0-3:4-7
+		/// </summary>
+		std::vector<std::vector<int>> GetCpuSetsOption(const Options &options) {
+
+			std::vector<std::vector<int>> cpuSets;
+
+			std::stringstream stream(GetOption(options, "cpus", ""));
+			std::string set;
+
+			while( std::getline(stream, set, ':') ) {
+
+				std::vector<int> cpus;
+
+				for( const std::string &item : SplitList(set) ) {
+
+					int first, last;
+					int parsed = sscanf(item.c_str(), "%d-%d", &first, &last);
+
+					if( parsed < 1 || first < 0 ) {
+						throw std::invalid_argument("invalid CPU " + item);
+					}
+
+					if( parsed == 1 ) last = first;
+
+					for( int cpu = first; cpu <= last; cpu++ ) {
+						cpus.push_back(cpu);
+					}
+
+				}
+
+				if( !cpus.empty() ) cpuSets.push_back(cpus);
+
+			}
+
+			return cpuSets;
+		}
+
+		int Simulate(const Options &options) {
+
+			SimulationConfig config;
+			config.BoardSizes = GetBoardSizesOption(options, "4");
+			config.Policies = GetPoliciesOption(options, "random,greedy");
+			config.Games = GetNumberOption(options, "games", 1000);
+			config.Threads = GetThreadsOption(options);
+			config.Seed = GetNumberOption(options, "seed", 0);
+			config.TwoProbability = GetProbabilityOption(options, "two-probability", DefaultTwoProbability);
+
+			std::string format = GetOption(options, "format", "csv");
+			if( format != "csv" && format != "json" ) {
+				throw std::invalid_argument("unknown format " + format);
+			}
+
+			StatisticsTable statistics;
+
+			// shard directory turns on multi-process mode, otherwise threads of this process play all games
+			if( options.count("shard-dir") ) {
+
+				ShardConfig shardConfig;
+				shardConfig.Simulation = config;
+				shardConfig.Directory = GetOption(options, "shard-dir", "");
+				shardConfig.Workers = GetNumberOption(options, "workers", 1);
+				shardConfig.Shards = GetNumberOption(options, "shards", std::max(1u, shardConfig.Workers));
+				shardConfig.CpuSets = GetCpuSetsOption(options);
+
+				if( shardConfig.Shards == 0 || shardConfig.Shards > config.Games ) {
+					throw std::invalid_argument("shards has to be between 1 and number of games");
+				}
+
+				// without explicit threads every worker gets its CPU set or equal part of machine
+				if( !options.count("threads") ) {
+					shardConfig.Simulation.Threads = !shardConfig.CpuSets.empty() ? shardConfig.CpuSets.front().size() :
+						std::max(1u, std::thread::hardware_concurrency() / std::max(1u, shardConfig.Workers));
+				}
+
+				std::string machine = GetOption(options, "machine", "0/1");
+				if( sscanf(machine.c_str(), "%u/%u", &shardConfig.MachineIndex, &shardConfig.MachineCount) != 2 ||
+					shardConfig.MachineCount == 0 || shardConfig.MachineIndex >= shardConfig.MachineCount ) {
+					throw std::invalid_argument("machine has to be index/count, e.g. 0/2");
+				}
+
+				std::error_code error;
+				std::filesystem::create_directories(shardConfig.Directory, error);
+
+				ShardReport report = RunShardedSimulation(shardConfig);
+
+				fprintf(stderr, "Shards: %u total, %u reused, %u played, %u failed, %u missing, %.2f s\n", shardConfig.Shards,
+					report.Reused, report.Completed, report.Failed, report.Missing, report.Seconds);
+
+				// partial statistics would look like complete ones, run again to resume missing shards
+				if( report.Missing > 0 ) {
+					throw std::runtime_error(std::to_string(report.Missing) + " shards are missing, run again to resume them");
+				}
+
+				statistics = std::move(report.Statistics);
+
+			} else {
+				statistics = RunSimulation(config);
+			}
+
+			std::ofstream fileStream;
+			std::string output = GetOption(options, "output", "");
+
+			if( !output.empty() ) {
+
+				fileStream.open(output, std::ofstream::out | std::ofstream::trunc);
+
+				if( !fileStream.is_open() ) {
+					throw std::runtime_error("cannot open " + output);
+				}
+
+			}
+
+			std::ostream &stream = output.empty() ? std::cout : fileStream;
+
+			if( format == "json" ) {
+				WriteStatisticsJson(stream, statistics);
+			} else {
+				WriteStatisticsCsv(stream, statistics);
+			}
+
+			return EXIT_SUCCESS;
+		}
+
+		int CrossCheck(const Options &options) {
+
+			CrossCheckConfig config;
+			config.BoardSizes = GetBoardSizesOption(options, "3,4,5");
+			config.Boards = GetNumberOption(options, "boards", 1000000);
+			config.Threads = GetThreadsOption(options);
+			config.Seed = GetNumberOption(options, "seed", 0);
+			config.MaxMismatches = GetNumberOption(options, "mismatches", 1);
+
+			CrossCheckReport report = RunCrossCheck(config);
+
+			printf("Checked %llu boards (%llu moves) in %.2f s, %.0f boards/s\n", (unsigned long long) report.Boards,
+				(unsigned long long) report.Boards * 4, report.Seconds, report.Boards / std::max(report.Seconds, 1e-9));
+
+			for( const CrossCheckMismatch &mismatch : report.Mismatches ) {
+				printf("\nMismatch: %s\n%s", mismatch.Description.c_str(), FormatBoard(mismatch.Board).c_str());
+			}
+
+			return report.Mismatches.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+
+		int Corpus(const Options &options) {
+
+			// existing corpus is replayed, otherwise new one is recorded
+			if( options.count("check") ) {
+
+				std::string file = GetOption(options, "check", "");
+
+				std::vector<CorpusEntry> entries;
+				if( !LoadCorpus(file, entries) ) {
+					throw std::runtime_error("cannot read corpus " + file);
+				}
+
+				CorpusReport report = VerifyCorpus(entries, GetThreadsOption(options));
+
+				printf("Checked %llu games in %.2f s, %.0f games/s, %zu mismatches\n", (unsigned long long) report.Checked,
+					report.Seconds, report.Checked / std::max(report.Seconds, 1e-9), report.Mismatches.size());
+
+				std::size_t shown = std::min<std::size_t>(report.Mismatches.size(), GetNumberOption(options, "mismatches", 10));
+
+				for( std::size_t i = 0; i < shown; i++ ) {
+
+					const CorpusMismatch &mismatch = report.Mismatches[i];
+					const CorpusEntry &expected = entries[mismatch.Index];
+
+					printf("\nMismatch: size %d, policy %s, seed %llu\n  expected %u moves %s\n  actual   %u moves %s\n", expected.BoardSize,
+						expected.Policy.c_str(), (unsigned long long) expected.Seed, expected.Moves, expected.Position.c_str(),
+						mismatch.Actual.Moves, mismatch.Actual.Position.c_str());
+
+				}
+
+				return report.Mismatches.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+			}
+
+			CorpusConfig config;
+			config.BoardSizes = GetBoardSizesOption(options, "3,4");
+			config.Policies = GetPoliciesOption(options, "random,greedy");
+			config.Games = GetNumberOption(options, "games", 1000);
+			config.Seed = GetNumberOption(options, "seed", 0);
+			config.Threads = GetThreadsOption(options);
+
+			for( const std::string &policy : config.Policies ) {
+				if( !IsReproduciblePolicy(policy) ) {
+					throw std::invalid_argument("policy " + policy + " depends on time, give it search depth");
+				}
+			}
+
+			std::string output = GetOption(options, "output", "corpus.txt");
+
+			auto start = std::chrono::steady_clock::now();
+
+			std::vector<CorpusEntry> entries = GenerateCorpus(config);
+			if( !SaveCorpus(output, entries) ) {
+				throw std::runtime_error("cannot write " + output);
+			}
+
+			printf("Wrote %zu games to %s in %.2f s\n", entries.size(), output.c_str(),
+				std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+			return EXIT_SUCCESS;
+		}
+
+		int Tournament(const Options &options) {
+
+			TournamentConfig config;
+			config.Policies = GetPoliciesOption(options, "random,greedy,montecarlo:50,expectimax:1,expectimax:2,heuristic");
+			config.Games = GetNumberOption(options, "games", 100);
+			config.Threads = GetThreadsOption(options);
+			config.Seed = GetNumberOption(options, "seed", 0);
+
+			for( int8_t boardSize : GetBoardSizesOption(options, "4") ) {
+
+				config.BoardSize = boardSize;
+
+				WriteTournamentReport(std::cout, RunTournament(config));
+				std::cout << std::endl;
+
+			}
+
+			return EXIT_SUCCESS;
+		}
+
+		/// <summary>
+		/// Board from comma separated tile values in row-major order
+		/// </summary>
+		GameBoard ParseBoardOption(const std::string &values) {
+
+			std::vector<std::string> items = SplitList(values);
+
+			int8_t boardSize = MinBoardSize;
+			while( boardSize * boardSize < (int) items.size() ) boardSize++;
+
+			if( boardSize > MaxBoardSize || boardSize * boardSize != (int) items.size() ) {
+				throw std::invalid_argument("board needs 9, 16 or 25 tiles");
+			}
+
+			GameBoard board(boardSize, std::pmr::vector<uint16_t>(boardSize));
+
+			for( std::size_t i = 0; i < items.size(); i++ ) {
+
+				unsigned long value = std::stoul(items[i]);
+
+				if( value == 1 || value > 32768 || (value & (value - 1)) != 0 ) {
+					throw std::invalid_argument("tile " + items[i] + " is not power of two");
+				}
+
+				board[i / boardSize][i % boardSize] = value;
+
+			}
+
+			return board;
+		}
+
+		int Perft(const Options &options) {
+
+			PerftConfig config;
+			config.Depth = GetNumberOption(options, "depth", 3);
+			config.Threads = GetThreadsOption(options);
+			config.Deduplicate = GetNumberOption(options, "dedup", 0) != 0;
+			config.HashBits = GetNumberOption(options, "hash-bits", 24);
+
+			if( config.HashBits < 10 || config.HashBits > 34 ) {
+				throw std::invalid_argument("hash-bits has to be between 10 and 34");
+			}
+
+			std::string engine = GetOption(options, "engine", "game");
+			if( engine != "game" && engine != "packed" ) {
+				throw std::invalid_argument("unknown engine " + engine);
+			}
+
+			config.Packed = engine == "packed";
+
+			// without explicit board start of seeded game is used
+			if( options.count("board") ) {
+				config.Board = ParseBoardOption(GetOption(options, "board", ""));
+			} else if( options.count("position") ) {
+
+				Game game;
+				if( !game.SetPosition(GetOption(options, "position", "")) ) {
+					throw std::invalid_argument("malformed position " + GetOption(options, "position", ""));
+				}
+
+				config.Board = game.GetBoard();
+
+			} else {
+
+				Game game(GetBoardSizesOption(options, "4").front(), GetNumberOption(options, "seed", 0));
+				game.StartGame();
+
+				config.Board = game.GetBoard();
+
+			}
+
+			if( config.Packed && !IsPackedBoardSize(config.Board.size()) ) {
+				throw std::invalid_argument("packed engine supports only boards 3x3 and 4x4");
+			}
+
+			printf("%s", FormatBoard(config.Board).c_str());
+
+			PerftReport report = RunPerft(config);
+
+			uint64_t total = 0;
+
+			for( std::size_t depth = 0; depth < report.Nodes.size(); depth++ ) {
+
+				printf("depth %2d %20llu\n", (int) depth, (unsigned long long) report.Nodes[depth]);
+				total += report.Nodes[depth];
+
+			}
+
+			printf("%s %llu nodes (%llu generated) in %.3f s, %.0f nodes/s\n", config.Deduplicate ? "Distinct" : "Total",
+				(unsigned long long) total, (unsigned long long) report.Generated, report.Seconds,
+				report.Generated / std::max(report.Seconds, 1e-9));
+
+			if( !report.Complete ) {
+				printf("Deduplication set was full, counts are not exact, use bigger --hash-bits\n");
+				return EXIT_FAILURE;
+			}
+
+			return EXIT_SUCCESS;
+		}
+
+		int Book(const Options &options) {
+
+			OpeningBookConfig config;
+			config.BoardSize = GetBoardSizesOption(options, "4").front();
+			config.Depth = GetNumberOption(options, "depth", 2);
+			config.SearchDepth = GetNumberOption(options, "search-depth", 3);
+			config.Threads = GetThreadsOption(options);
+
+			if( !IsPackedBoardSize(config.BoardSize) ) {
+				throw std::invalid_argument("opening book supports only boards 3x3 and 4x4");
+			}
+
+			std::string output = GetOption(options, "output", GetOpeningBookFile(config.BoardSize));
+
+			OpeningBookReport report;
+			if( !BuildOpeningBook(config, output, report) ) {
+				throw std::runtime_error("cannot write " + output);
+			}
+
+			printf("Wrote %llu positions to %s in %.2f s\n", (unsigned long long) report.Positions, output.c_str(), report.Seconds);
+
+			return EXIT_SUCCESS;
+		}
+
+		int Analyze(const Options &options) {
+
+			AnalysisConfig config;
+			config.SearchDepth = GetNumberOption(options, "depth", 3);
+			config.Rollouts = GetNumberOption(options, "rollouts", 100);
+			config.Policy = GetOption(options, "policy", "greedy");
+			config.Threads = GetThreadsOption(options);
+			config.Seed = GetNumberOption(options, "seed", 0);
+
+			if( !CreatePolicy(config.Policy, 0) ) {
+				throw std::invalid_argument("unknown policy " + config.Policy);
+			}
+
+			if( !options.count("position") ) {
+				throw std::invalid_argument("missing --position, e.g. 4:1100/0000/0000/0002:0");
+			}
+
+			std::string position = GetOption(options, "position", "");
+
+			Game game;
+			if( !game.SetPosition(position) ) {
+				throw std::invalid_argument("malformed position " + position);
+			}
+
+			printf("%s\n", FormatBoard(game.GetBoard()).c_str());
+
+			WriteAnalysisReport(std::cout, AnalyzePosition(game, config));
+
+			return EXIT_SUCCESS;
+		}
+
+		int Regret(const Options &options) {
+
+			RegretConfig config;
+			config.Rollouts = GetNumberOption(options, "rollouts", 20);
+			config.Policy = GetOption(options, "rollout-policy", "greedy");
+			config.Threads = GetThreadsOption(options);
+			config.Seed = GetNumberOption(options, "seed", 0);
+
+			if( !CreatePolicy(config.Policy, 0) ) {
+				throw std::invalid_argument("unknown policy " + config.Policy);
+			}
+
+			GameRecord record;
+
+			// policy plays new game, otherwise recorded game is loaded
+			if( options.count("policy") ) {
+
+				std::string policyName = GetOption(options, "policy", "");
+
+				auto policy = CreatePolicy(policyName, GetPolicySeed(config.Seed));
+				if( !policy ) {
+					throw std::invalid_argument("unknown policy " + policyName);
+				}
+
+				Game game(GetBoardSizesOption(options, "4").front(), config.Seed);
+				game.StartGame();
+
+				record = RecordGame(game, *policy);
+
+			} else {
+
+				std::string file = GetOption(options, "game", LastGameFile);
+
+				if( !LoadGameRecord(file, record) ) {
+					throw std::runtime_error("cannot load game " + file);
+				}
+
+			}
+
+			std::string recordFile = GetOption(options, "record", "");
+			if( !recordFile.empty() && !SaveGameRecord(recordFile, record) ) {
+				throw std::runtime_error("cannot write " + recordFile);
+			}
+
+			RegretReport report = AnalyzeGame(record, config);
+
+			WriteRegretReport(std::cout, report, GetNumberOption(options, "top", 10));
+
+			std::string output = GetOption(options, "output", "");
+
+			if( !output.empty() ) {
+
+				std::ofstream stream(output, std::ofstream::out | std::ofstream::trunc);
+
+				if( !stream.is_open() ) {
+					throw std::runtime_error("cannot open " + output);
+				}
+
+				WriteRegretCsv(stream, report);
+
+			}
+
+			return EXIT_SUCCESS;
+		}
+
+		int Render(const Options &options) {
+
+			std::string rendererName = GetOption(options, "renderer", "ansi");
+			std::string policyName = GetOption(options, "policy", "greedy");
+
+			std::unique_ptr<Renderer> renderer = CreateRenderer(rendererName);
+			if( !renderer ) {
+				throw std::invalid_argument("unknown renderer " + rendererName);
+			}
+
+			std::unique_ptr<Policy> policy = CreatePolicy(policyName, GetPolicySeed(GetNumberOption(options, "seed", 0)));
+			if( !policy ) {
+				throw std::invalid_argument("unknown policy " + policyName);
+			}
+
+			std::vector<int8_t> boardSizes = GetBoardSizesOption(options, "4");
+			uint64_t frames = GetNumberOption(options, "frames", 1000);
+			uint64_t seed = GetNumberOption(options, "seed", 0);
+
+			// ncurses backend draws to real terminal, others get size from options
+			if( rendererName == "ncurses" ) {
+				UIInit();
+			}
+
+			int rows = rendererName == "ncurses" ? LINES : GetNumberOption(options, "rows", 40);
+			int cols = rendererName == "ncurses" ? COLS : GetNumberOption(options, "cols", 120);
+
+			renderer->Resize(rows, cols);
+
+			std::vector<ScoreRecord> highScores;
+
+			// same feed as interactive game, renderer headless measures game loop with publishing
+			LiveFeed feed;
+			if( options.count("feed") && !feed.Create(GetOption(options, "feed", ""), GetNumberOption(options, "feed-size", DefaultLiveFeedCapacity)) ) {
+				throw std::runtime_error("cannot create feed " + GetOption(options, "feed", ""));
+			}
+
+			Game game(boardSizes.front(), seed);
+			game.StartGame();
+
+			uint32_t moves = 0;
+			feed.Publish(game, moves);
+
+			GameFrame frame;
+			frame.CurrentGame = &game;
+			frame.HighScores = &highScores;
+
+			for( uint64_t i = 0; i < frames; i++ ) {
+
+				renderer->DrawGame(frame);
+
+				// finished game is shown once, next one starts with following seed
+				if( frame.GameOver ) {
+
+					ScoreRecord record;
+					record.BoardSize = game.GetBoardSize();
+					record.Score = game.GetScore();
+
+					// same order as leaderboard keeps
+					auto position = std::upper_bound(highScores.begin(), highScores.end(), record, [](const ScoreRecord &a, const ScoreRecord &b) {
+						return a.Score > b.Score;
+					});
+
+					highScores.insert(position, record);
+
+					game.Seed(++seed);
+					game.StartGame();
+					frame.GameOver = false;
+
+					moves = 0;
+					feed.Publish(game, moves);
+
+					continue;
+				}
+
+				game.MoveBoard(policy->ChooseMove(game));
+				game.AddRandomTile();
+
+				feed.Publish(game, ++moves);
+
+				frame.GameOver = game.GetLegalMoves() == 0;
+
+			}
+
+			RenderStatistics statistics = renderer->GetStatistics();
+
+			// destructor of ansi renderer restores terminal
+			renderer.reset();
+
+			if( rendererName == "ncurses" ) {
+				UIDeInit();
+			}
+
+			double perFrame = std::max<uint64_t>(statistics.Frames, 1);
+
+			fprintf(stderr, "%s: %llu frames, %.2f us/frame, %.1f bytes/frame, %.2f writes/frame\n", rendererName.c_str(),
+				(unsigned long long) statistics.Frames, statistics.Nanoseconds / 1000.0 / perFrame, statistics.Bytes / perFrame,
+				statistics.Writes / perFrame);
+
+			return EXIT_SUCCESS;
+		}
+
+		int Play(const Options &options) {
+
+			if( options.count("feed") && !GetLiveFeed().Create(GetOption(options, "feed", ""), GetNumberOption(options, "feed-size", DefaultLiveFeedCapacity)) ) {
+				throw std::runtime_error("cannot create feed " + GetOption(options, "feed", ""));
+			}
+
+			// seeded games are determined by seed and moves, restart plays the same game again
+			int result = options.count("seed") ? RunInteractive(true, GetNumberOption(options, "seed", 0)) : RunInteractive();
+
+			GetLiveFeed().Close();
+
+			return result;
+		}
+
+		int Watch(const Options &options) {
+
+			std::string name = GetOption(options, "feed", "");
+
+			LiveFeedReader reader;
+			if( !reader.Open(name) ) {
+				throw std::runtime_error("cannot open feed " + name);
+			}
+
+			uint64_t count = GetNumberOption(options, "count", 0);
+			std::string from = GetOption(options, "from", "latest");
+
+			if( from != "latest" && from != "oldest" ) {
+				throw std::invalid_argument("from has to be latest or oldest");
+			}
+
+			uint64_t next = reader.GetWriteIndex();
+			if( from == "oldest" ) next = next > reader.GetCapacity() ? next - reader.GetCapacity() : 0;
+
+			uint64_t shown = 0, skipped = 0;
+
+			// reader only polls, producer never waits for it
+			while( count == 0 || shown < count ) {
+
+				bool closed = reader.IsClosed();
+				uint64_t written = reader.GetWriteIndex();
+
+				if( next >= written ) {
+
+					if( closed ) break;
+
+					fflush(stdout);
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+					continue;
+				}
+
+				// entries older than capacity are overwritten already
+				if( written - next > reader.GetCapacity() ) {
+					skipped += written - reader.GetCapacity() - next;
+					next = written - reader.GetCapacity();
+				}
+
+				LiveFeedState state;
+
+				if( reader.Read(next, state) ) {
+
+					printf("%llu %u %llu.%09llu %s\n", (unsigned long long) state.Index, state.Move, (unsigned long long) (state.Timestamp / 1000000000),
+						(unsigned long long) (state.Timestamp % 1000000000), EncodePosition(state.GetBoard(), state.Score).c_str());
+
+					shown++;
+
+				} else {
+					skipped++;
+				}
+
+				next++;
+
+			}
+
+			fflush(stdout);
+
+			if( skipped > 0 ) {
+				fprintf(stderr, "Skipped %llu entries overwritten before they were read\n", (unsigned long long) skipped);
+			}
+
+			return EXIT_SUCCESS;
+		}
+
+	}
+
+	int RunCommand(const int argc, const char **argv) {
+
+		std::string command = argv[1];
+
+		try {
+
+			Options options = ParseOptions(argc, argv);
+
+			// search cache is shared by hints, expectimax policies and analysis of every command
+			if( options.count("cache-mb") ) {
+				GetSearchCache().SetBudget(GetNumberOption(options, "cache-mb", 0) << 20);
+			}
+
+			if( command == "simulate" ) return Simulate(options);
+			if( command == "corpus" ) return Corpus(options);
+			if( command == "crosscheck" ) return CrossCheck(options);
+			if( command == "tournament" ) return Tournament(options);
+			if( command == "perft" ) return Perft(options);
+			if( command == "book" ) return Book(options);
+			if( command == "render" ) return Render(options);
+			if( command == "analyze" ) return Analyze(options);
+			if( command == "regret" ) return Regret(options);
+			if( command == "play" ) return Play(options);
+			if( command == "watch" ) return Watch(options);
+
+			if( command == "help" || command == "--help" ) {
+				std::cout << CommandUsage;
+				return EXIT_SUCCESS;
+			}
+
+			std::cerr << "Unknown command " << command << "\n\n" << CommandUsage;
+
+		} catch( const std::exception &exception ) {
+			std::cerr << command << ": " << exception.what() << std::endl;
+		}
+
+		return EXIT_FAILURE;
+	}
+
+}
@@ -0,0 +1,54 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <string>
+
+namespace Game2048 {
+
+	const std::string CommandUsage =
+		"Usage: 2048 [command] [--option value ...]\n"
+		"Without command interactive game is started. Every command accepts --cache-mb 16, memory of cache\n"
+		"of search results shared by hints, expectimax policies and analysis (0 turns it off).\n"
+		"\n"
+		"Commands:\n"
+		"  simulate   play games automatically and aggregate statistics\n"
+		"             --games 1000 --sizes 4 --policies random,greedy --threads N --seed 0\n"
+		"             --format csv|json --output file --two-probability 0.5\n"
+		"             --shard-dir dir --workers N --shards N --cpus 0-3:4-7 --machine 0/1  (multi-process, resumable)\n"
+		"  tournament play policies on identical seeds and compare them pairwise with confidence intervals\n"
+		"             --games 100 --sizes 4 --policies random,greedy,montecarlo:50,expectimax:2,heuristic --threads N --seed 0\n"
+		"  corpus     record final positions of seeded games, --check replays recorded corpus as regression test\n"
+		"             --games 1000 --sizes 3,4 --policies random,greedy --seed 0 --threads N --output corpus.txt\n"
+		"             --check corpus.txt --mismatches 10\n"
+		"  crosscheck compare reference move rules with faster engines on random and adversarial boards\n"
+		"             --boards 1000000 --sizes 3,4,5 --threads N --seed 0 --mismatches 1\n"
+		"  perft      count positions reachable by moves and spawns to given depth\n"
+		"             --depth 3 --sizes 4 --seed 0 --board 2,0,0,... --position 4:1100/0000/0000/0002\n"
+		"             --engine game|packed --dedup 0|1 --hash-bits 24 --threads N\n"
+		"  book       build opening book of early positions used by expectimax and hints\n"
+		"             --sizes 4 --depth 2 --search-depth 3 --threads N --output book4.bin\n"
+		"  render     play game and draw every position, prints cost of frames to stderr\n"
+		"             --renderer ansi|ncurses|headless --frames 1000 --sizes 4 --policy greedy --seed 0\n"
+		"             --rows 40 --cols 120 --feed /name --feed-size 4096\n"
+		"  analyze    search and play out every legal move of position given as size:hex exponent rows:score\n"
+		"             --position 4:1100/0000/0000/0002:0 --depth 3 --rollouts 100 --policy greedy --threads N --seed 0\n"
+		"  regret     play out every move of recorded game in parallel and list moves losing most expected score\n"
+		"             --game lastgame.txt | --policy greedy --sizes 4 --record file, --rollouts 20 --rollout-policy greedy\n"
+		"             --threads N --seed 0 --top 10 --output regret.csv\n"
+		"  play       interactive game, --seed starts every game from given seed, --feed publishes every position\n"
+		"             to shared memory ring\n"
+		"             --seed 42 --feed /2048-feed --feed-size 4096\n"
+		"  watch      print positions of feed published by play or render\n"
+		"             --feed /2048-feed --from latest|oldest --count 0\n"
+		"  help       print this message\n";
+
+	/// <summary>
+	/// Runs command given on command line instead of interactive game
+	/// </summary>
+	/// <param name="argc"></param>
+	/// <param name="argv"></param>
+	/// <returns>process exit code</returns>
+	int RunCommand(const int argc, const char **argv);
+
+}
@@ -0,0 +1,168 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "Corpus.h"
+#include "Policy.h"
+#include "Simulation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace Game2048 {
+
+	namespace {
+
+		/// <summary>
+		/// Calls task with every index below count across threads, every index is claimed exactly once
+		/// </summary>
+		template<typename Task>
+		void RunParallel(const std::size_t count, const unsigned threads, Task &&task) {
+
+			std::atomic<std::size_t> next = 0;
+			std::vector<std::thread> workers;
+
+			for( unsigned t = 0; t < std::max(1u, threads); t++ ) {
+
+				workers.emplace_back([&]() {
+
+					for( std::size_t i = next++; i < count; i = next++ ) {
+						task(i);
+					}
+
+				});
+
+			}
+
+			for( std::thread &worker : workers ) {
+				worker.join();
+			}
+
+		}
+
+	}
+
+	bool IsReproduciblePolicy(const std::string &name) {
+		return name != "expectimax";
+	}
+
+	bool PlayCorpusGame(CorpusEntry &entry) {
+
+		// the same game as simulate plays with this seed
+		auto policy = CreatePolicy(entry.Policy, GetPolicySeed(entry.Seed));
+		if( !policy ) return false;
+
+		Game game(entry.BoardSize, entry.Seed);
+		game.StartGame();
+
+		entry.Moves = SimulateGame(game, *policy).Moves;
+		entry.Position = game.GetPosition();
+
+		return true;
+	}
+
+	std::vector<CorpusEntry> GenerateCorpus(const CorpusConfig &config) {
+
+		std::vector<CorpusEntry> entries;
+
+		for( int8_t boardSize : config.BoardSizes ) {
+			for( const std::string &policy : config.Policies ) {
+				for( uint64_t i = 0; i < config.Games; i++ ) {
+
+					CorpusEntry entry;
+					entry.BoardSize = boardSize;
+					entry.Policy = policy;
+					entry.Seed = config.Seed + i;
+
+					entries.push_back(entry);
+
+				}
+			}
+		}
+
+		// every thread fills only entries it claimed
+		RunParallel(entries.size(), config.Threads, [&](const std::size_t i) {
+			PlayCorpusGame(entries[i]);
+		});
+
+		return entries;
+	}
+
+	CorpusReport VerifyCorpus(const std::vector<CorpusEntry> &entries, const unsigned threads) {
+
+		auto start = std::chrono::steady_clock::now();
+
+		std::vector<CorpusEntry> actual(entries.size());
+		std::vector<uint8_t> matches(entries.size());
+
+		RunParallel(entries.size(), threads, [&](const std::size_t i) {
+
+			actual[i].BoardSize = entries[i].BoardSize;
+			actual[i].Policy = entries[i].Policy;
+			actual[i].Seed = entries[i].Seed;
+
+			matches[i] = PlayCorpusGame(actual[i]) && actual[i].Moves == entries[i].Moves && actual[i].Position == entries[i].Position;
+
+		});
+
+		CorpusReport report;
+		report.Checked = entries.size();
+
+		for( std::size_t i = 0; i < entries.size(); i++ ) {
+			if( !matches[i] ) report.Mismatches.push_back({ i, actual[i] });
+		}
+
+		report.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return report;
+	}
+
+	bool SaveCorpus(const std::string &file, const std::vector<CorpusEntry> &entries) {
+
+		std::ofstream stream(file, std::ofstream::out | std::ofstream::trunc);
+		if( !stream.is_open() ) return false;
+
+		stream << "# size policy seed moves position\n";
+
+		for( const CorpusEntry &entry : entries ) {
+			stream << int(entry.BoardSize) << ' ' << entry.Policy << ' ' << entry.Seed << ' ' << entry.Moves << ' ' << entry.Position << '\n';
+		}
+
+		return stream.good();
+	}
+
+	bool LoadCorpus(const std::string &file, std::vector<CorpusEntry> &entries) {
+
+		std::ifstream stream(file);
+		if( !stream.is_open() ) return false;
+
+		std::vector<CorpusEntry> loaded;
+		Game game;
+
+		std::string line;
+
+		while( std::getline(stream, line) ) {
+
+			if( line.empty() || line[0] == '#' ) continue;
+
+			std::istringstream lineStream(line);
+
+			CorpusEntry entry;
+			int boardSize = 0;
+
+			if( !(lineStream >> boardSize >> entry.Policy >> entry.Seed >> entry.Moves >> entry.Position) ) return false;
+			if( !game.SetPosition(entry.Position) || game.GetBoardSize() != boardSize ) return false;
+
+			entry.BoardSize = boardSize;
+			loaded.push_back(entry);
+
+		}
+
+		entries = std::move(loaded);
+
+		return true;
+	}
+
+}
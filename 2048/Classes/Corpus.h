@@ -0,0 +1,104 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Game.h"
+
+namespace Game2048 {
+
+	/// <summary>
+	/// Games recorded to regression corpus, every game is played exactly like by simulate
+	/// </summary>
+	struct CorpusConfig {
+
+		std::vector<int8_t> BoardSizes { 3, 4 };
+		std::vector<std::string> Policies { "random", "greedy" };
+
+		// Seeds Seed .. Seed + Games - 1 are played by every policy on every board size
+		uint64_t Games = 1000;
+		uint64_t Seed = 0;
+
+		unsigned Threads = 1;
+
+	};
+
+	/// <summary>
+	/// One game of corpus, it is fully determined by board size, policy and seed
+	/// </summary>
+	struct CorpusEntry {
+
+		int8_t BoardSize = 4;
+		std::string Policy;
+		uint64_t Seed = 0;
+
+		uint32_t Moves = 0;
+
+		// Final board and score as text position of EncodePosition
+		std::string Position;
+
+	};
+
+	struct CorpusMismatch {
+
+		// Index of entry in checked corpus
+		std::size_t Index = 0;
+
+		// Game played now
+		CorpusEntry Actual;
+
+	};
+
+	struct CorpusReport {
+
+		uint64_t Checked = 0;
+
+		// Sorted by index
+		std::vector<CorpusMismatch> Mismatches;
+
+		double Seconds = 0;
+
+	};
+
+	/// <summary>
+	/// Can policy of given name replay its games? Expectimax without depth stops on time budget, so it can not.
+	/// </summary>
+	bool IsReproduciblePolicy(const std::string &name);
+
+	/// <summary>
+	/// Plays single game of corpus from its start to game over
+	/// </summary>
+	/// <param name="entry">board size, policy and seed, moves and position are filled</param>
+	/// <returns>false for unknown policy</returns>
+	bool PlayCorpusGame(CorpusEntry &entry);
+
+	/// <summary>
+	/// Plays all games of config across threads
+	/// </summary>
+	/// <param name="config"></param>
+	/// <returns>entries ordered by board size, policy and seed, the same for any number of threads</returns>
+	std::vector<CorpusEntry> GenerateCorpus(const CorpusConfig &config);
+
+	/// <summary>
+	/// Plays every game of corpus again across threads and compares its moves and final position
+	/// </summary>
+	/// <param name="entries"></param>
+	/// <param name="threads"></param>
+	/// <returns></returns>
+	CorpusReport VerifyCorpus(const std::vector<CorpusEntry> &entries, const unsigned threads);
+
+	/// <summary>
+	/// Writes corpus as text, one line "size policy seed moves position" per game
+	/// </summary>
+	bool SaveCorpus(const std::string &file, const std::vector<CorpusEntry> &entries);
+
+	/// <summary>
+	/// Reads corpus of SaveCorpus, lines starting with # are comments
+	/// </summary>
+	/// <returns>false if file can not be read or any line is malformed</returns>
+	bool LoadCorpus(const std::string &file, std::vector<CorpusEntry> &entries);
+
+}
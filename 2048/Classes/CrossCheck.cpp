@@ -0,0 +1,398 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "CrossCheck.h"
+#include "Evaluator.h"
+#include "PackedBoard.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace Game2048 {
+
+	namespace {
+
+		// boards claimed by thread at once
+		const uint64_t CrossCheckChunk = 1024;
+
+		const char *GetDirectionName(const Direction direction) {
+
+			switch( direction ) {
+				case Direction::UP: return "up";
+				case Direction::RIGHT: return "right";
+				case Direction::DOWN: return "down";
+				case Direction::LEFT: return "left";
+				default: return "none";
+			}
+
+		}
+
+		/// <summary>
+		/// Fills board with random tiles, most kinds aim at corner cases of move rules
+		/// </summary>
+		void GenerateBoard(std::minstd_rand &random, GameBoard &board) {
+
+			int8_t boardSize = board.size();
+
+			uint8_t kind = random() % 5;
+			uint8_t base = 1 + random() % 14;
+			uint8_t emptyPercent = random() % 100;
+
+			for( int8_t row = 0; row < boardSize; row++ ) {
+				for( int8_t col = 0; col < boardSize; col++ ) {
+
+					uint8_t exponent = 0;
+
+					switch( kind ) {
+
+						case 0: // any tiles
+							exponent = random() % 16;
+							break;
+
+						case 1: // two neighbouring values, long merge chains
+							exponent = base + random() % 2;
+							break;
+
+						case 2: // whole rows of the same value, merge order matters
+							exponent = base + (random() % 4 == 0);
+							break;
+
+						case 3: // biggest tiles, 32768 + 32768 overflows
+							exponent = 13 + random() % 3;
+							break;
+
+						default: // full board, mostly without moves
+							exponent = 1 + (row + col) % 2 + 2 * (random() % 8 == 0);
+							emptyPercent = 0;
+							break;
+
+					}
+
+					bool empty = (uint8_t) (random() % 100) < emptyPercent;
+					board[row][col] = empty || exponent == 0 ? 0 : 1 << exponent;
+
+				}
+			}
+
+		}
+
+		/// <summary>
+		/// Removes and lowers tiles while engines still disagree
+		/// </summary>
+		GameBoard ShrinkBoard(CrossChecker &checker, GameBoard board) {
+
+			bool shrunk = true;
+
+			while( shrunk ) {
+
+				shrunk = false;
+
+				for( auto &row : board ) {
+					for( uint16_t &value : row ) {
+
+						if( value == 0 ) continue;
+
+						uint16_t original = value;
+
+						for( uint16_t candidate : { (uint16_t) 0, (uint16_t) (value / 2) } ) {
+
+							if( candidate == 1 ) continue;
+
+							value = candidate;
+
+							if( !checker.Check(board).empty() ) {
+								shrunk = true;
+								break;
+							}
+
+							value = original;
+
+						}
+
+					}
+				}
+
+			}
+
+			return board;
+		}
+
+	}
+
+	CrossChecker::CrossChecker(const int8_t boardSize) : BoardSize(boardSize), Reference(boardSize, 0), Moved(boardSize, 0), Rehashed(boardSize, 0) {}
+
+	std::string CrossChecker::CheckSymmetries(const PackedBoard board) const {
+
+		Symmetry canonicalSymmetry;
+		PackedBoard canonical = CanonicalizeBoard(board, BoardSize, canonicalSymmetry, DihedralSymmetries);
+
+		if( TransformBoard(board, BoardSize, canonicalSymmetry) != canonical ) {
+			return "canonical symmetry " + std::to_string(canonicalSymmetry) + " does not transform board to canonical board";
+		}
+
+		for( Symmetry symmetry = 0; symmetry < SymmetryCount; symmetry++ ) {
+
+			PackedBoard transformed = TransformBoard(board, BoardSize, symmetry);
+
+			if( TransformBoard(transformed, BoardSize, InverseSymmetry(symmetry)) != board ) {
+				return "inverse of symmetry " + std::to_string(symmetry) + " does not restore board";
+			}
+
+			Symmetry otherSymmetry;
+			if( CanonicalizeBoard(transformed, BoardSize, otherSymmetry, DihedralSymmetries) != canonical ) {
+				return "symmetry " + std::to_string(symmetry) + " of board has different canonical board";
+			}
+
+		}
+
+		return "";
+	}
+
+	std::string CrossChecker::Check(const GameBoard &board) {
+
+		Reference.SetBoard(board, 0);
+
+		uint8_t legalMoves = Reference.GetLegalMoves();
+
+		// IsMovePossible() reports empty board as playable although no direction moves it
+		bool empty = Reference.GetMaxTile() == 0;
+
+		if( !empty && (legalMoves != 0) != Reference.IsMovePossible() ) {
+			return "cached legal moves " + std::to_string(legalMoves) + " disagree with IsMovePossible()";
+		}
+
+		bool packed = IsPackedBoardSize(BoardSize);
+
+		if( packed && GetPackedLegalMoves(PackBoard(board), BoardSize) != legalMoves ) {
+			return "packed legal moves " + std::to_string(GetPackedLegalMoves(PackBoard(board), BoardSize)) + " differ from " + std::to_string(legalMoves);
+		}
+
+		if( packed ) {
+
+			std::string description = CheckSymmetries(PackBoard(board));
+			if( !description.empty() ) return description;
+
+			// evaluator row tables have to score the same as tile by tile evaluation
+			static const HeuristicEvaluator evaluator;
+
+			if( evaluator.Evaluate(PackBoard(board), BoardSize) != evaluator.EvaluateScalar(Reference) ) {
+				return "evaluation from row tables differs from tile by tile evaluation";
+			}
+
+		}
+
+		for( Direction direction : Directions ) {
+
+			std::string name = GetDirectionName(direction);
+
+			if( bool(legalMoves & DirectionMask(direction)) != Reference.IsMovePossible(direction) ) {
+				return name + ": cached legal moves disagree with IsMovePossible(direction)";
+			}
+
+			Moved = Reference;
+			MoveResult result = Moved.MoveBoard(direction);
+
+			if( result.Changed != (Moved.GetBoard() != board) ) {
+				return name + ": MoveResult.Changed does not match board";
+			}
+
+			if( result.Changed != Reference.IsMovePossible(direction) ) {
+				return name + ": board changed although IsMovePossible(direction) says otherwise";
+			}
+
+			if( result.ScoreDelta != Moved.GetScore() ) {
+				return name + ": MoveResult.ScoreDelta differs from score";
+			}
+
+			Rehashed.SetBoard(Moved.GetBoard(), 0);
+
+			if( Rehashed.GetHash() != Moved.GetHash() ) {
+				return name + ": incrementally updated hash differs from hash of moved board";
+			}
+
+			for( Direction next : Directions ) {
+				if( bool(result.LegalMoves & DirectionMask(next)) != Moved.IsMovePossible(next) ) {
+					return name + ": MoveResult.LegalMoves disagree with IsMovePossible(" + GetDirectionName(next) + ") of result";
+				}
+			}
+
+			if( !packed ) continue;
+
+			PackedBoard packedBoard = PackBoard(board);
+			MoveResult packedResult = MovePackedBoard(packedBoard, BoardSize, direction);
+
+			if( packedBoard != PackBoard(Moved.GetBoard()) ) {
+				return name + ": packed board moved to\n" + FormatBoard(UnpackBoard(packedBoard, BoardSize)) + "instead of\n" + FormatBoard(Moved.GetBoard());
+			}
+
+			if( packedResult.ScoreDelta != result.ScoreDelta || packedResult.Merges != result.Merges ) {
+				return name + ": packed score " + std::to_string(packedResult.ScoreDelta) + " (" + std::to_string(packedResult.Merges) + " merges) instead of "
+					+ std::to_string(result.ScoreDelta) + " (" + std::to_string(result.Merges) + " merges)";
+			}
+
+			if( packedResult.Changed != result.Changed || packedResult.LegalMoves != result.LegalMoves ) {
+				return name + ": packed MoveResult.Changed or LegalMoves differ";
+			}
+
+			// exact symmetries have to commute with move
+			for( Symmetry symmetry = 1; symmetry < SymmetryCount; symmetry++ ) {
+
+				if( !(ExactSymmetries & (1 << symmetry)) ) continue;
+
+				PackedBoard transformed = TransformBoard(PackBoard(board), BoardSize, symmetry);
+				MoveResult transformedResult = MovePackedBoard(transformed, BoardSize, TransformDirection(direction, symmetry));
+
+				if( transformed != TransformBoard(packedBoard, BoardSize, symmetry) || transformedResult.ScoreDelta != packedResult.ScoreDelta ) {
+					return name + ": move does not commute with exact symmetry " + std::to_string(symmetry);
+				}
+
+			}
+
+		}
+
+		return "";
+	}
+
+	CrossCheckReport RunCrossCheck(const CrossCheckConfig &config) {
+
+		auto start = std::chrono::steady_clock::now();
+
+		uint64_t totalBoards = config.Boards * config.BoardSizes.size();
+
+		std::atomic<uint64_t> nextBoard = 0;
+		std::atomic<uint64_t> checkedBoards = 0;
+		std::atomic<bool> stop = false;
+
+		CrossCheckReport report;
+		std::mutex reportMutex;
+
+		unsigned threadCount = std::max(1u, config.Threads);
+		std::vector<std::thread> threads;
+
+		for( unsigned t = 0; t < threadCount; t++ ) {
+
+			threads.emplace_back([&]() {
+
+				std::vector<CrossChecker> checkers;
+				std::vector<GameBoard> boards;
+
+				// packed boards of chunk which passed single-board checks, batched kernel has to agree with them
+				std::vector<std::vector<PackedBoard>> packedBoards(config.BoardSizes.size());
+				std::vector<std::vector<uint8_t>> packedMoves(config.BoardSizes.size());
+				std::vector<uint8_t> batchMoves;
+
+				for( int8_t boardSize : config.BoardSizes ) {
+					checkers.emplace_back(boardSize);
+					boards.emplace_back(boardSize, std::pmr::vector<uint16_t>(boardSize));
+				}
+
+				auto reportMismatch = [&](const GameBoard &board, const std::string &description) {
+
+					std::lock_guard<std::mutex> lock(reportMutex);
+
+					if( report.Mismatches.size() < config.MaxMismatches ) {
+						report.Mismatches.push_back({ board, description });
+					}
+
+					stop = report.Mismatches.size() >= config.MaxMismatches;
+
+				};
+
+				while( !stop ) {
+
+					uint64_t first = nextBoard.fetch_add(CrossCheckChunk);
+					if( first >= totalBoards ) break;
+
+					uint64_t last = std::min(first + CrossCheckChunk, totalBoards);
+
+					// every chunk has own generator, so found boards do not depend on thread count
+					std::minstd_rand random(config.Seed * 0x9E3779B97F4A7C15 + first / CrossCheckChunk + 1);
+
+					for( uint64_t i = first; i < last && !stop; i++ ) {
+
+						checkedBoards++;
+
+						std::size_t sizeIndex = i % config.BoardSizes.size();
+
+						GenerateBoard(random, boards[sizeIndex]);
+						std::string description = checkers[sizeIndex].Check(boards[sizeIndex]);
+
+						if( description.empty() ) {
+
+							if( IsPackedBoardSize(config.BoardSizes[sizeIndex]) ) {
+
+								PackedBoard packed = PackBoard(boards[sizeIndex]);
+								packedBoards[sizeIndex].push_back(packed);
+								packedMoves[sizeIndex].push_back(GetPackedLegalMoves(packed, config.BoardSizes[sizeIndex]));
+
+							}
+
+							continue;
+						}
+
+						auto board = ShrinkBoard(checkers[sizeIndex], boards[sizeIndex]);
+						reportMismatch(board, checkers[sizeIndex].Check(board));
+
+					}
+
+					for( std::size_t sizeIndex = 0; sizeIndex < config.BoardSizes.size(); sizeIndex++ ) {
+
+						const std::vector<PackedBoard> &packed = packedBoards[sizeIndex];
+						const std::vector<uint8_t> &expected = packedMoves[sizeIndex];
+
+						batchMoves.resize(packed.size());
+						std::size_t finished = GetPackedLegalMoves(packed.data(), packed.size(), config.BoardSizes[sizeIndex], batchMoves.data());
+
+						for( std::size_t i = 0; i < packed.size(); i++ ) {
+							if( batchMoves[i] != expected[i] ) {
+								reportMismatch(UnpackBoard(packed[i], config.BoardSizes[sizeIndex]), "batched legal moves " +
+									std::to_string(batchMoves[i]) + " differ from " + std::to_string(expected[i]));
+								break;
+							}
+						}
+
+						if( finished != (std::size_t) std::count(expected.begin(), expected.end(), 0) ) {
+							reportMismatch(UnpackBoard(packed.front(), config.BoardSizes[sizeIndex]), "batched game-over count differs");
+						}
+
+						packedBoards[sizeIndex].clear();
+						packedMoves[sizeIndex].clear();
+
+					}
+
+				}
+
+			});
+
+		}
+
+		for( std::thread &thread : threads ) {
+			thread.join();
+		}
+
+		report.Boards = checkedBoards;
+		report.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return report;
+	}
+
+	std::string FormatBoard(const GameBoard &board) {
+
+		std::stringstream stream;
+
+		for( const auto &row : board ) {
+			for( uint16_t value : row ) {
+				stream.width(6);
+				stream << value;
+			}
+			stream << "\n";
+		}
+
+		return stream.str();
+	}
+
+}
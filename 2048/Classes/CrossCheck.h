@@ -0,0 +1,88 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Game.h"
+#include "PackedBoard.h"
+
+namespace Game2048 {
+
+	/// <summary>
+	/// Compares Game::MoveBoard, IsMovePossible and scoring (reference) with faster engines:
+	/// legal-move mask and hash kept by Game and packed boards moved by row tables.
+	/// Packed boards also check symmetries used for canonical boards and evaluator row tables.
+	/// </summary>
+	class CrossChecker {
+
+	public:
+
+		CrossChecker(const int8_t boardSize);
+
+		/// <summary>
+		/// Runs all engines on given board in every direction
+		/// </summary>
+		/// <param name="board"></param>
+		/// <returns>empty string if engines agree, otherwise description of first difference</returns>
+		std::string Check(const GameBoard &board);
+
+	private:
+
+		std::string CheckSymmetries(const PackedBoard board) const;
+
+		int8_t BoardSize;
+
+		// Reused for every board, so checking does not allocate
+		Game Reference;
+		Game Moved;
+		Game Rehashed;
+
+	};
+
+	struct CrossCheckConfig {
+
+		std::vector<int8_t> BoardSizes { 3, 4, 5 };
+
+		// Boards checked for every board size
+		uint64_t Boards = 1000000;
+
+		unsigned Threads = 1;
+
+		uint64_t Seed = 0;
+
+		// Checking stops after this many mismatches
+		std::size_t MaxMismatches = 1;
+
+	};
+
+	struct CrossCheckMismatch {
+
+		// Board shrunk to fewest and smallest tiles which still show the difference
+		GameBoard Board;
+
+		std::string Description;
+
+	};
+
+	struct CrossCheckReport {
+		uint64_t Boards = 0;
+		double Seconds = 0;
+		std::vector<CrossCheckMismatch> Mismatches;
+	};
+
+	/// <summary>
+	/// Checks random and adversarial boards of all configured sizes across threads
+	/// </summary>
+	/// <param name="config"></param>
+	/// <returns></returns>
+	CrossCheckReport RunCrossCheck(const CrossCheckConfig &config);
+
+	/// <summary>
+	/// Formats board as rows of tile values
+	/// </summary>
+	std::string FormatBoard(const GameBoard &board);
+
+}
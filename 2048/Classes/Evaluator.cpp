@@ -0,0 +1,221 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "Evaluator.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace Game2048 {
+
+	bool LoadEvaluatorWeights(const std::string &fileName, EvaluatorWeights &weights) {
+
+		const std::map<std::string, double EvaluatorWeights::*> names {
+			{ "base", &EvaluatorWeights::Base },
+			{ "empty", &EvaluatorWeights::Empty },
+			{ "merges", &EvaluatorWeights::Merges },
+			{ "monotonicity", &EvaluatorWeights::Monotonicity },
+			{ "monotonicity_power", &EvaluatorWeights::MonotonicityPower },
+			{ "smoothness", &EvaluatorWeights::Smoothness },
+			{ "sum", &EvaluatorWeights::Sum },
+			{ "sum_power", &EvaluatorWeights::SumPower }
+		};
+
+		// read only stream
+		std::ifstream fileStream;
+		fileStream.open(fileName);
+
+		if( !fileStream.is_open() ) return false;
+
+		std::string line;
+		while( std::getline(fileStream, line) ) {
+
+			line = line.substr(0, line.find('#'));
+			std::replace(line.begin(), line.end(), '=', ' ');
+
+			std::stringstream lineStream(line);
+
+			std::string name;
+			if( !(lineStream >> name) ) continue; // empty line
+
+			double value;
+			auto weight = names.find(name);
+
+			if( weight == names.end() || !(lineStream >> value) ) return false;
+
+			weights.*(weight->second) = value;
+
+		}
+
+		return true;
+	}
+
+	HeuristicEvaluator::HeuristicEvaluator() : HeuristicEvaluator(EvaluatorWeights()) {}
+
+	HeuristicEvaluator::HeuristicEvaluator(const EvaluatorWeights &weights) : Weights(weights) {
+
+		for( int8_t boardSize = MinBoardSize; boardSize <= MaxBoardSize; boardSize++ ) {
+
+			if( !IsPackedBoardSize(boardSize) ) continue;
+
+			std::vector<float> &scores = LineScores[boardSize];
+			scores.resize(std::size_t(1) << (4 * boardSize));
+
+			for( std::size_t row = 0; row < scores.size(); row++ ) {
+
+				uint8_t exponents[MaxBoardSize];
+				for( int8_t i = 0; i < boardSize; i++ ) {
+					exponents[i] = (row >> (4 * i)) & 0xF;
+				}
+
+				scores[row] = EvaluateLine(exponents, boardSize);
+
+			}
+
+		}
+
+	}
+
+	float HeuristicEvaluator::EvaluateLine(const uint8_t *exponents, const int8_t size) const {
+
+		double sum = 0;
+		double smoothness = 0;
+		int empty = 0;
+		int merges = 0;
+
+		uint8_t previous = 0;
+		int counter = 0;
+
+		for( int8_t i = 0; i < size; i++ ) {
+
+			uint8_t exponent = exponents[i];
+			sum += std::pow(exponent, Weights.SumPower);
+
+			if( exponent == 0 ) {
+				empty++;
+				continue;
+			}
+
+			if( previous != 0 ) {
+				smoothness += std::abs(exponent - previous);
+			}
+
+			// run of equal tiles separated only by empty tiles
+			if( previous == exponent ) {
+				counter++;
+			} else if( counter > 0 ) {
+				merges += 1 + counter;
+				counter = 0;
+			}
+
+			previous = exponent;
+
+		}
+
+		if( counter > 0 ) {
+			merges += 1 + counter;
+		}
+
+		double monotonicityLow = 0;
+		double monotonicityHigh = 0;
+
+		for( int8_t i = 1; i < size; i++ ) {
+
+			double first = std::pow(exponents[i - 1], Weights.MonotonicityPower);
+			double second = std::pow(exponents[i], Weights.MonotonicityPower);
+
+			if( exponents[i - 1] > exponents[i] ) {
+				monotonicityLow += first - second;
+			} else {
+				monotonicityHigh += second - first;
+			}
+
+		}
+
+		return Weights.Base + Weights.Empty * empty + Weights.Merges * merges
+			- Weights.Monotonicity * std::min(monotonicityLow, monotonicityHigh)
+			- Weights.Smoothness * smoothness - Weights.Sum * sum;
+
+	}
+
+	double HeuristicEvaluator::Evaluate(const Game &game) const {
+
+		int8_t boardSize = game.GetBoardSize();
+
+		if( IsPackedBoardSize(boardSize) ) {
+			return Evaluate(PackBoard(game.GetBoard()), boardSize);
+		}
+
+		return EvaluateScalar(game);
+	}
+
+	double HeuristicEvaluator::Evaluate(const PackedBoard board, const int8_t boardSize) const {
+
+		const std::vector<float> &scores = LineScores[boardSize];
+		const PackedBoard rowMask = (PackedBoard(1) << (4 * boardSize)) - 1;
+
+		// columns are rows of transposed board
+		PackedBoard transposed = TransformBoard(board, boardSize, SYMMETRY_TRANSPOSE);
+
+		double score = 0;
+
+		for( int8_t i = 0; i < boardSize; i++ ) {
+			score += scores[(board >> (4 * boardSize * i)) & rowMask];
+			score += scores[(transposed >> (4 * boardSize * i)) & rowMask];
+		}
+
+		return score;
+	}
+
+	double HeuristicEvaluator::EvaluateScalar(const Game &game) const {
+
+		const auto &board = game.GetBoard();
+		int8_t boardSize = game.GetBoardSize();
+
+		uint8_t rowExponents[MaxBoardSize];
+		uint8_t columnExponents[MaxBoardSize];
+
+		double score = 0;
+
+		for( int8_t i = 0; i < boardSize; i++ ) {
+
+			for( int8_t j = 0; j < boardSize; j++ ) {
+				rowExponents[j] = board[i][j] != 0 ? std::countr_zero(board[i][j]) : 0;
+				columnExponents[j] = board[j][i] != 0 ? std::countr_zero(board[j][i]) : 0;
+			}
+
+			score += EvaluateLine(rowExponents, boardSize);
+			score += EvaluateLine(columnExponents, boardSize);
+
+		}
+
+		return score;
+	}
+
+	const HeuristicEvaluator &GetDefaultEvaluator() {
+
+		static const HeuristicEvaluator evaluator = []() {
+
+			EvaluatorWeights weights;
+			EvaluatorWeights loaded;
+
+			// partly read file would mix its weights with defaults
+			if( LoadEvaluatorWeights(EvaluatorWeightsFile, loaded) ) {
+				weights = loaded;
+			} else if( std::filesystem::exists(EvaluatorWeightsFile) ) {
+				fprintf(stderr, "Ignoring invalid %s, default evaluator weights are used\n", EvaluatorWeightsFile.c_str());
+			}
+
+			return HeuristicEvaluator(weights);
+
+		}();
+
+		return evaluator;
+	}
+
+}
@@ -0,0 +1,107 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Game.h"
+#include "PackedBoard.h"
+
+namespace Game2048 {
+
+	const std::string EvaluatorWeightsFile = "weights.txt";
+
+	/// <summary>
+	/// Weights of heuristic terms, every row and column is scored separately and summed
+	/// </summary>
+	struct EvaluatorWeights {
+
+		// Constant per line, keeps scores of living positions positive
+		double Base = 200000;
+
+		// Per empty tile
+		double Empty = 270;
+
+		// Per tile which can merge with neighbour
+		double Merges = 700;
+
+		// Penalty of tiles not ordered in one direction, tile counts as exponent^MonotonicityPower
+		double Monotonicity = 47;
+		double MonotonicityPower = 4;
+
+		// Penalty of exponent differences between neighbouring tiles
+		double Smoothness = 0;
+
+		// Penalty of big tiles away from being merged, tile counts as exponent^SumPower
+		double Sum = 11;
+		double SumPower = 3.5;
+
+	};
+
+	/// <summary>
+	/// Loads weights from file with "name = value" lines (base, empty, merges, monotonicity,
+	/// monotonicity_power, smoothness, sum, sum_power), # starts comment, missing names keep their value
+	/// </summary>
+	/// <param name="fileName"></param>
+	/// <param name="weights"></param>
+	/// <returns>false if file cannot be opened or contains unknown name or invalid value</returns>
+	bool LoadEvaluatorWeights(const std::string &fileName, EvaluatorWeights &weights);
+
+	/// <summary>
+	/// Scores leaf positions of search, bigger is better
+	/// </summary>
+	class Evaluator {
+
+	public:
+
+		virtual ~Evaluator() = default;
+
+		virtual double Evaluate(const Game &game) const = 0;
+
+	};
+
+	/// <summary>
+	/// Scores monotonicity, smoothness, empty tiles and merge potential of every row and column.
+	/// Scores of all possible rows of packed boards are precomputed, so 4x4 board costs 8 table lookups,
+	/// other sizes are scored tile by tile.
+	/// </summary>
+	class HeuristicEvaluator : public Evaluator {
+
+	public:
+
+		HeuristicEvaluator();
+		HeuristicEvaluator(const EvaluatorWeights &weights);
+
+		double Evaluate(const Game &game) const override;
+
+		/// <summary>
+		/// Scores packed board from row tables
+		/// </summary>
+		double Evaluate(const PackedBoard board, const int8_t boardSize) const;
+
+		/// <summary>
+		/// Scores board of any size tile by tile
+		/// </summary>
+		double EvaluateScalar(const Game &game) const;
+
+	private:
+
+		float EvaluateLine(const uint8_t *exponents, const int8_t size) const;
+
+		EvaluatorWeights Weights;
+
+		// Score of every packed row, indexed by board size
+		std::vector<float> LineScores[MaxBoardSize + 1];
+
+	};
+
+	/// <summary>
+	/// Evaluator shared by policies and hints, weights are loaded from EvaluatorWeightsFile if it exists.
+	/// First call prints warning about invalid file to stderr, so UI makes it before ncurses starts.
+	/// </summary>
+	/// <returns></returns>
+	const HeuristicEvaluator &GetDefaultEvaluator();
+
+}
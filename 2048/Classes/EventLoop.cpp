@@ -0,0 +1,182 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "EventLoop.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace Game2048 {
+
+	EventLoop::EventLoop() {
+
+		// ncurses handler of SIGWINCH never runs, resize is read from descriptor instead
+		sigset_t signals;
+		sigemptyset(&signals);
+		sigaddset(&signals, SIGWINCH);
+		pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+		SignalDescriptor = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+		RedrawDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	}
+
+	EventLoop::~EventLoop() {
+
+		for( int timer : Timers ) {
+			close(timer);
+		}
+
+		if( SignalDescriptor >= 0 ) close(SignalDescriptor);
+		if( RedrawDescriptor >= 0 ) close(RedrawDescriptor);
+
+	}
+
+	Event EventLoop::WaitEvent(WINDOW *window) {
+
+		while( PendingEvents.empty() ) {
+
+			// ncurses may hold keys read earlier, they come first
+			ReadKeys(window);
+			if( !PendingEvents.empty() ) break;
+
+			std::vector<pollfd> descriptors {
+				{ STDIN_FILENO, POLLIN, 0 },
+				{ SignalDescriptor, POLLIN, 0 },
+				{ RedrawDescriptor, POLLIN, 0 }
+			};
+
+			for( int timer : Timers ) {
+				descriptors.push_back({ timer, POLLIN, 0 });
+			}
+
+			if( poll(descriptors.data(), descriptors.size(), -1) < 0 ) {
+				if( errno == EINTR ) continue;
+				break;
+			}
+
+			if( descriptors[0].revents & POLLIN ) {
+				ReadKeys(window);
+			}
+
+			if( descriptors[1].revents & POLLIN ) {
+				ReadResize();
+			}
+
+			if( descriptors[2].revents & POLLIN ) {
+
+				// any number of requests ends with one redraw
+				uint64_t requests;
+				if( read(RedrawDescriptor, &requests, sizeof(requests)) == sizeof(requests) ) {
+					PendingEvents.push_back({ EVENT_REDRAW, ERR, -1 });
+				}
+
+			}
+
+			for( std::size_t i = 3; i < descriptors.size(); i++ ) {
+
+				if( !(descriptors[i].revents & POLLIN) ) continue;
+
+				uint64_t expirations;
+				if( read(descriptors[i].fd, &expirations, sizeof(expirations)) == sizeof(expirations) ) {
+					PendingEvents.push_back({ EVENT_TIMER, ERR, descriptors[i].fd });
+				}
+
+			}
+
+		}
+
+		// poll failed for other reason than signal, let caller treat it as quit
+		if( PendingEvents.empty() ) return { EVENT_KEY, 'q', -1 };
+
+		Event event = PendingEvents.front();
+		PendingEvents.pop_front();
+
+		return event;
+	}
+
+	void EventLoop::ReadKeys(WINDOW *window) {
+
+		nodelay(window, true);
+
+		int key;
+		while( (key = wgetch(window)) != ERR ) {
+			PendingEvents.push_back({ EVENT_KEY, key, -1 });
+		}
+
+	}
+
+	void EventLoop::ReadResize() {
+
+		signalfd_siginfo signal;
+		while( read(SignalDescriptor, &signal, sizeof(signal)) == sizeof(signal) ) {}
+
+		winsize size;
+		if( ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) < 0 ) return;
+
+		// layout is computed again only if size really changed
+		if( size.ws_row == LINES && size.ws_col == COLS ) return;
+
+		resizeterm(size.ws_row, size.ws_col);
+		PendingEvents.push_back({ EVENT_RESIZE, ERR, -1 });
+
+	}
+
+	void EventLoop::PostRedraw() {
+
+		uint64_t request = 1;
+		if( write(RedrawDescriptor, &request, sizeof(request)) < 0 ) {
+			// counter is full, redraw is pending anyway
+		}
+
+	}
+
+	int EventLoop::AddTimer(const std::chrono::milliseconds interval, const bool repeat) {
+
+		int timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		if( timer < 0 ) return -1;
+
+		itimerspec specification {};
+		specification.it_value.tv_sec = interval.count() / 1000;
+		specification.it_value.tv_nsec = (interval.count() % 1000) * 1000000;
+
+		if( repeat ) {
+			specification.it_interval = specification.it_value;
+		}
+
+		timerfd_settime(timer, 0, &specification, nullptr);
+		Timers.push_back(timer);
+
+		return timer;
+	}
+
+	void EventLoop::RemoveTimer(const int timer) {
+
+		auto found = std::find(Timers.begin(), Timers.end(), timer);
+		if( found == Timers.end() ) return;
+
+		close(timer);
+		Timers.erase(found);
+
+		// expirations read before removal must not be delivered
+		std::erase_if(PendingEvents, [timer](const Event &event) {
+			return event.Type == EVENT_TIMER && event.Timer == timer;
+		});
+
+	}
+
+	EventLoop &GetEventLoop() {
+
+		static EventLoop eventLoop;
+		return eventLoop;
+
+	}
+
+}
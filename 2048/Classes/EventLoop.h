@@ -0,0 +1,89 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include <ncurses.h>
+
+namespace Game2048 {
+
+	enum EventType {
+		EVENT_KEY, EVENT_RESIZE, EVENT_TIMER, EVENT_REDRAW
+	};
+
+	struct Event {
+
+		EventType Type = EVENT_KEY;
+
+		// Pressed key of EVENT_KEY
+		int Key = ERR;
+
+		// Expired timer of EVENT_TIMER
+		int Timer = -1;
+
+	};
+
+	/// <summary>
+	/// Single place where UI waits. Keyboard, terminal resize (SIGWINCH), timers and redraw requests
+	/// of background threads are multiplexed with poll, so UI never blocks in getch.
+	/// </summary>
+	class EventLoop {
+
+	public:
+
+		/// <summary>
+		/// Blocks SIGWINCH for calling thread and threads created later, it is received through signalfd
+		/// </summary>
+		EventLoop();
+		~EventLoop();
+
+		EventLoop(const EventLoop &) = delete;
+		EventLoop &operator=(const EventLoop &) = delete;
+
+		/// <summary>
+		/// Waits for next event, keys are read from given window. Terminal is resized before
+		/// EVENT_RESIZE is returned, signals which do not change its size are dropped.
+		/// </summary>
+		/// <param name="window"></param>
+		/// <returns></returns>
+		Event WaitEvent(WINDOW *window);
+
+		/// <summary>
+		/// Wakes loop with EVENT_REDRAW, may be called from any thread
+		/// </summary>
+		void PostRedraw();
+
+		/// <summary>
+		/// Starts timer which produces EVENT_TIMER
+		/// </summary>
+		/// <param name="interval"></param>
+		/// <param name="repeat">fire every interval instead of once</param>
+		/// <returns>timer id or -1 on failure</returns>
+		int AddTimer(const std::chrono::milliseconds interval, const bool repeat);
+
+		void RemoveTimer(const int timer);
+
+	private:
+
+		void ReadKeys(WINDOW *window);
+		void ReadResize();
+
+		int SignalDescriptor = -1;
+		int RedrawDescriptor = -1;
+
+		// timerfd of every timer, it is also timer id
+		std::vector<int> Timers;
+
+		std::deque<Event> PendingEvents;
+
+	};
+
+	/// <summary>
+	/// Event loop of UI, created by UIInit
+	/// </summary>
+	EventLoop &GetEventLoop();
+
+}
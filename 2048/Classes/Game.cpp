@@ -2,41 +2,125 @@
 
 #include "Game.h"
 #include "HighScore.h"
+#include "PositionCodec.h"
 #include "UI.h"
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <fstream>
 
 namespace Game2048 {
 
-	Game::Game(const int8_t BoardSize) {
+	namespace {
+
+		constexpr uint64_t SplitMix64(uint64_t &state) {
+
+			uint64_t value = (state += 0x9E3779B97F4A7C15);
+			value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+			value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+
+			return value ^ (value >> 31);
+		}
+
+		// Random key of every tile exponent on every cell, empty cell has key 0
+		using ZobristTable = std::array<std::array<uint64_t, 16>, MaxBoardSize * MaxBoardSize>;
+
+		constexpr ZobristTable BuildZobristKeys() {
+
+			ZobristTable keys {};
+			uint64_t state = 2048;
+
+			for( auto &cellKeys : keys ) {
+				for( std::size_t exponent = 1; exponent < cellKeys.size(); exponent++ ) {
+					cellKeys[exponent] = SplitMix64(state);
+				}
+			}
+
+			return keys;
+		}
+
+		constexpr ZobristTable ZobristKeys = BuildZobristKeys();
+
+	}
+
+	Game::Game(const int8_t BoardSize, const uint64_t seed) {
 
 		this->BoardSize = BoardSize;
-		this->Board = std::vector(BoardSize, std::vector<uint16_t>(BoardSize));
+		this->Board = GameBoard(BoardSize, std::pmr::vector<uint16_t>(BoardSize));
+		this->LineMoves = std::pmr::vector<uint8_t>(BoardSize * 2);
+
+		Seed(seed);
 
 	}
 
+	Game::Game(const Game &other, std::pmr::memory_resource *resource) :
+		BoardSize(other.BoardSize), Score(other.Score), Board(other.Board, resource), Random(other.Random),
+		TwoProbability(other.TwoProbability), LineMoves(other.LineMoves, resource), LegalMoves(other.LegalMoves), Hash(other.Hash) {}
+
+	// games without explicit seed follow global rand() seeded in main
+	Game::Game(const int8_t BoardSize) : Game(BoardSize, rand()) {}
+
 	Game::Game() : Game(4) {}
 
+	void Game::Seed(const uint64_t seed) {
+
+		// spread seed over whole generator state, neighbouring seeds must not give similar games
+		std::seed_seq sequence { static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) };
+		Random.seed(sequence);
+
+	}
+
 	void Game::AddRandomTile() {
 
-		if( !IsPossibleToAddTile() ) return;
+		SpawnOutcomes outcomes;
+		std::size_t count = GetSpawnOutcomes(outcomes);
+
+		if( count == 0 ) return;
 
-		int8_t row = row = rand() % BoardSize;
-		int8_t col = row = rand() % BoardSize;
+		// uniform number from [0, 1) goes through cumulative probabilities of outcomes
+		double sample = static_cast<double>(Random() - Random.min()) / (static_cast<double>(Random.max() - Random.min()) + 1);
 
-		while( !IsRowSuitable(row) ) {
-			row = rand() % BoardSize;
+		std::size_t chosen = 0;
+		while( chosen + 1 < count && sample >= outcomes[chosen].Probability ) {
+			sample -= outcomes[chosen++].Probability;
 		}
 
-		while( Board[row][col] != 0 ) {
-			col = rand() % BoardSize;
+		AddTile(outcomes[chosen].Row, outcomes[chosen].Col, outcomes[chosen].Value);
+
+	}
+
+	std::size_t Game::GetSpawnOutcomes(SpawnOutcomes &outcomes) const {
+
+		uint32_t emptyCells = 0;
+
+		for( int8_t row = 0; row < BoardSize; row++ ) {
+			for( int8_t col = 0; col < BoardSize; col++ ) {
+				if( Board[row][col] == 0 ) emptyCells |= uint32_t(1) << (row * BoardSize + col);
+			}
 		}
 
-		Board[row][col] = rand() % 2 == 0 ? 2 : 4;
+		return ListSpawnOutcomes(emptyCells, BoardSize, TwoProbability, outcomes);
+	}
 
+	void Game::SetTwoProbability(const double probability) {
+		TwoProbability = std::clamp(probability, 0.0, 1.0);
 	}
 
-	void Game::MoveBoard(const Direction direction) {
+	double Game::GetTwoProbability() const {
+		return TwoProbability;
+	}
+
+	void Game::AddTile(const int8_t row, const int8_t col, const uint16_t value) {
+
+		SetTile(row, col, value);
+		UpdateLegalMoves(row, col);
+
+	}
+
+	MoveResult Game::MoveBoard(const Direction direction) {
+
+		MoveResult result;
 
 		switch( direction ) {
 
@@ -56,10 +140,11 @@ namespace Game2048 {
 							if( secondValue == 0 ) continue;
 							if( value != secondValue ) break;
 
-							Board[row][col] = value * 2;
-							Board[newRow][col] = 0;
+							SetTile(row, col, value * 2);
+							SetTile(newRow, col, 0);
 
-							Score += Board[row][col];
+							result.ScoreDelta += Board[row][col];
+							result.Merges++;
 							break;
 
 						}
@@ -79,8 +164,9 @@ namespace Game2048 {
 
 								if( Board[newRow][col] == 0 ) continue;
 
-								Board[row][col] = Board[newRow][col];
-								Board[newRow][col] = 0;
+								SetTile(row, col, Board[newRow][col]);
+								SetTile(newRow, col, 0);
+								result.Changed = true;
 								break;
 
 							}
@@ -99,8 +185,9 @@ namespace Game2048 {
 
 								if( Board[newRow][col] == 0 ) continue;
 
-								Board[row][col] = Board[newRow][col];
-								Board[newRow][col] = 0;
+								SetTile(row, col, Board[newRow][col]);
+								SetTile(newRow, col, 0);
+								result.Changed = true;
 								break;
 
 							}
@@ -128,10 +215,11 @@ namespace Game2048 {
 							if( secondValue == 0 ) continue;
 							if( value != secondValue ) break;
 
-							Board[row][col] = value * 2;
-							Board[row][newCol] = 0;
+							SetTile(row, col, value * 2);
+							SetTile(row, newCol, 0);
 
-							Score += Board[row][col];
+							result.ScoreDelta += Board[row][col];
+							result.Merges++;
 							break;
 
 						}
@@ -151,8 +239,9 @@ namespace Game2048 {
 
 								if( Board[row][newCol] == 0 ) continue;
 
-								Board[row][col] = Board[row][newCol];
-								Board[row][newCol] = 0;
+								SetTile(row, col, Board[row][newCol]);
+								SetTile(row, newCol, 0);
+								result.Changed = true;
 								break;
 
 							}
@@ -171,8 +260,9 @@ namespace Game2048 {
 
 								if( Board[row][newCol] == 0 ) continue;
 
-								Board[row][col] = Board[row][newCol];
-								Board[row][newCol] = 0;
+								SetTile(row, col, Board[row][newCol]);
+								SetTile(row, newCol, 0);
+								result.Changed = true;
 								break;
 
 							}
@@ -187,6 +277,14 @@ namespace Game2048 {
 				break;
 		}
 
+		Score += result.ScoreDelta;
+
+		result.Changed = result.Changed || result.Merges > 0;
+
+		UpdateLegalMoves();
+		result.LegalMoves = LegalMoves;
+
+		return result;
 	}
 
 	bool Game::IsMovePossible() const {
@@ -278,26 +376,125 @@ namespace Game2048 {
 		return false;
 	}
 
-	bool Game::IsPossibleToAddTile() const {
+	uint64_t Game::GetHash() const {
+		return this->Hash;
+	}
+
+	uint64_t Game::GetTileKey(const int8_t row, const int8_t col, const uint16_t value) const {
+		return value != 0 ? ZobristKeys[row * BoardSize + col][std::countr_zero(value)] : 0;
+	}
+
+	void Game::SetTile(const int8_t row, const int8_t col, const uint16_t value) {
+
+		Hash ^= GetTileKey(row, col, Board[row][col]) ^ GetTileKey(row, col, value);
+		Board[row][col] = value;
+
+	}
+
+	uint8_t Game::GetLegalMoves() const {
+		return this->LegalMoves;
+	}
+
+	uint8_t Game::GetRowMoves(const int8_t row) const {
+
+		uint8_t moves = 0;
+
+		// every pair of neighbours decides whether one of them can slide or merge into other
+		for( int8_t col = 0; col < BoardSize - 1; col++ ) {
+
+			uint16_t left = Board[row][col];
+			uint16_t right = Board[row][col + 1];
+
+			if( left == 0 && right == 0 ) continue;
+
+			if( left == 0 ) moves |= MASK_LEFT;
+			else if( right == 0 ) moves |= MASK_RIGHT;
+			else if( left == right ) moves |= MASK_LEFT | MASK_RIGHT;
 
-		for( int8_t row = 0; row < BoardSize; row++ ) {
-			for( int8_t col = 0; col < BoardSize; col++ ) {
-				if( Board[row][col] == 0 ) return true;
-			}
 		}
 
-		return false;
+		return moves;
 	}
 
-	bool Game::IsRowSuitable(const int8_t rowIndex) const {
+	uint8_t Game::GetColumnMoves(const int8_t col) const {
+
+		uint8_t moves = 0;
+
+		for( int8_t row = 0; row < BoardSize - 1; row++ ) {
+
+			uint16_t upper = Board[row][col];
+			uint16_t lower = Board[row + 1][col];
+
+			if( upper == 0 && lower == 0 ) continue;
+
+			if( upper == 0 ) moves |= MASK_UP;
+			else if( lower == 0 ) moves |= MASK_DOWN;
+			else if( upper == lower ) moves |= MASK_UP | MASK_DOWN;
 
-		for( int8_t col = 0; col < BoardSize; col++ ) {
-			if( Board[rowIndex][col] == 0 ) {
-				return true;
-			}
 		}
 
-		return false;
+		return moves;
+	}
+
+	void Game::UpdateLegalMoves() {
+
+		LegalMoves = 0;
+
+		for( int8_t i = 0; i < BoardSize; i++ ) {
+
+			LineMoves[i] = GetRowMoves(i);
+			LineMoves[BoardSize + i] = GetColumnMoves(i);
+
+			LegalMoves |= LineMoves[i] | LineMoves[BoardSize + i];
+
+		}
+
+	}
+
+	void Game::UpdateLegalMoves(const int8_t row, const int8_t col) {
+
+		// single changed tile affects only its row and column
+		LineMoves[row] = GetRowMoves(row);
+		LineMoves[BoardSize + col] = GetColumnMoves(col);
+
+		LegalMoves = 0;
+		for( uint8_t moves : LineMoves ) {
+			LegalMoves |= moves;
+		}
+
+	}
+
+	uint8_t DirectionMask(const Direction direction) {
+
+		switch( direction ) {
+			case Direction::UP: return MASK_UP;
+			case Direction::RIGHT: return MASK_RIGHT;
+			case Direction::DOWN: return MASK_DOWN;
+			case Direction::LEFT: return MASK_LEFT;
+			default: return 0;
+		}
+
+	}
+
+	std::size_t ListSpawnOutcomes(uint32_t emptyCells, const int8_t boardSize, const double twoProbability, SpawnOutcomes &outcomes) {
+
+		if( emptyCells == 0 ) return 0;
+
+		double cellProbability = 1.0 / std::popcount(emptyCells);
+		std::size_t count = 0;
+
+		for( ; emptyCells != 0; emptyCells &= emptyCells - 1 ) {
+
+			int cell = std::countr_zero(emptyCells);
+			int8_t row = cell / boardSize;
+			int8_t col = cell % boardSize;
+
+			if( twoProbability > 0 ) outcomes[count++] = { row, col, 2, cellProbability * twoProbability };
+			if( twoProbability < 1 ) outcomes[count++] = { row, col, 4, cellProbability * (1 - twoProbability) };
+
+		}
+
+		return count;
 	}
 
 	void Game::ClearBoard() {
@@ -309,6 +506,9 @@ namespace Game2048 {
 		}
 
 		Score = 0;
+		Hash = 0;
+
+		UpdateLegalMoves();
 	}
 
 	void Game::StartGame() {
@@ -319,6 +519,73 @@ namespace Game2048 {
 
 	}
 
+	bool Game::SetBoard(const GameBoard &board, const uint32_t score) {
+
+		if( board.size() != (std::size_t) BoardSize ) return false;
+
+		for( const auto &row : board ) {
+			if( row.size() != (std::size_t) BoardSize ) return false;
+		}
+
+		// assign row by row, existing rows are reused
+		Hash = 0;
+
+		for( int8_t row = 0; row < BoardSize; row++ ) {
+
+			Board[row].assign(board[row].begin(), board[row].end());
+
+			for( int8_t col = 0; col < BoardSize; col++ ) {
+				Hash ^= GetTileKey(row, col, Board[row][col]);
+			}
+
+		}
+
+		Score = score;
+
+		UpdateLegalMoves();
+
+		return true;
+	}
+
+	bool Game::SetPosition(const std::string &position) {
+
+		GameBoard board;
+		uint32_t score;
+
+		if( !DecodePosition(position, board, score) ) return false;
+
+		if( (std::size_t) BoardSize != board.size() ) Resize(board.size());
+
+		return SetBoard(board, score);
+	}
+
+	bool Game::SetPosition(const std::vector<uint8_t> &position) {
+
+		GameBoard board;
+		uint32_t score;
+
+		if( !DecodePositionBinary(position, board, score) ) return false;
+
+		if( (std::size_t) BoardSize != board.size() ) Resize(board.size());
+
+		return SetBoard(board, score);
+	}
+
+	std::string Game::GetPosition() const {
+		return EncodePosition(Board, Score);
+	}
+
+	void Game::Resize(const int8_t boardSize) {
+
+		// keep memory resource of board, game copied to arena stays there
+		BoardSize = boardSize;
+		Board.assign(boardSize, std::pmr::vector<uint16_t>(boardSize, Board.get_allocator()));
+		LineMoves.assign(boardSize * 2, 0);
+
+		ClearBoard();
+
+	}
+
 	uint32_t Game::GetScore() const {
 		return this->Score;
 	}
@@ -327,7 +594,20 @@ namespace Game2048 {
 		return this->BoardSize;
 	}
 
-	std::vector<std::vector<uint16_t>> Game::GetBoard() {
+	uint16_t Game::GetMaxTile() const {
+
+		uint16_t maxTile = 0;
+
+		for( const auto &row : Board ) {
+			for( uint16_t value : row ) {
+				maxTile = std::max(maxTile, value);
+			}
+		}
+
+		return maxTile;
+	}
+
+	const GameBoard &Game::GetBoard() const {
 		return this->Board;
 	}
 
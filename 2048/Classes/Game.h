@@ -2,15 +2,22 @@
 
 #pragma once
 
+#include <array>
 #include <iostream>
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <random>
+#include <memory_resource>
 
 #include <ncurses.h>
 
 namespace Game2048 {
 
+	// Board sizes offered by game
+	const int8_t MinBoardSize = 3;
+	const int8_t MaxBoardSize = 5;
+
 	enum Direction {
 		UP = KEY_UP,
 		RIGHT = KEY_RIGHT,
@@ -18,23 +25,147 @@ namespace Game2048 {
 		LEFT = KEY_LEFT
 	};
 
+	/// <summary>
+	/// Bit of every direction in legal-move mask
+	/// </summary>
+	enum MoveMask : uint8_t {
+		MASK_UP = 1 << 0,
+		MASK_RIGHT = 1 << 1,
+		MASK_DOWN = 1 << 2,
+		MASK_LEFT = 1 << 3
+	};
+
+	const Direction Directions[] { UP, RIGHT, DOWN, LEFT };
+
+	/// <summary>
+	/// Tiles of board by rows, storage comes from memory resource given to Game (heap by default)
+	/// </summary>
+	using GameBoard = std::pmr::vector<std::pmr::vector<uint16_t>>;
+
+	/// <summary>
+	/// Outcome of single move
+	/// </summary>
+	struct MoveResult {
+
+		// Was any tile moved or merged
+		bool Changed = false;
+
+		// Score gained by merges
+		uint32_t ScoreDelta = 0;
+
+		// Number of merged pairs
+		uint8_t Merges = 0;
+
+		// Legal-move mask of resulting position (MoveMask bits)
+		uint8_t LegalMoves = 0;
+
+	};
+
+	/// <summary>
+	/// One possible new tile of chance node
+	/// </summary>
+	struct SpawnOutcome {
+
+		int8_t Row = 0;
+		int8_t Col = 0;
+		uint16_t Value = 0;
+
+		double Probability = 0;
+
+	};
+
+	// Two values in every cell of biggest board
+	const std::size_t MaxSpawnOutcomes = 2 * MaxBoardSize * MaxBoardSize;
+
+	/// <summary>
+	/// Buffer for all spawn outcomes of position, lives on stack of caller
+	/// </summary>
+	using SpawnOutcomes = std::array<SpawnOutcome, MaxSpawnOutcomes>;
+
+	// Probability that new tile is 2 and not 4
+	const double DefaultTwoProbability = 0.5;
+
+	/// <summary>
+	/// Lists spawn outcomes of given empty cells, cell is uniformly chosen empty one and its value is 2
+	/// with given probability. Outcomes go by cells in row-major order, 2 before 4, outcomes
+	/// with zero probability are left out. Game and packed boards share it.
+	/// </summary>
+	/// <param name="emptyCells">bit row * boardSize + col is set for every empty cell</param>
+	/// <param name="boardSize"></param>
+	/// <param name="twoProbability"></param>
+	/// <param name="outcomes">buffer filled from beginning</param>
+	/// <returns>number of outcomes, 0 for full board</returns>
+	std::size_t ListSpawnOutcomes(uint32_t emptyCells, const int8_t boardSize, const double twoProbability, SpawnOutcomes &outcomes);
+
+	/// <summary>
+	/// Get legal-move mask bit of given direction
+	/// </summary>
+	/// <param name="direction"></param>
+	/// <returns></returns>
+	uint8_t DirectionMask(const Direction direction);
+
 	class Game {
 
 	public:
 
 		Game();
+
+		/// <summary>
+		/// Creates game with empty board of size MinBoardSize - MaxBoardSize
+		/// </summary>
 		Game(const int8_t BoardSize);
 
 		/// <summary>
-		/// Adds random tile to game board
+		/// Creates game with own random generator seeded by given seed
+		/// </summary>
+		Game(const int8_t BoardSize, const uint64_t seed);
+
+		/// <summary>
+		/// Copies game with board stored in given memory resource, search nodes use it to live in arena.
+		/// Plain copy of such game is stored on heap again.
+		/// </summary>
+		Game(const Game &other, std::pmr::memory_resource *resource);
+
+		/// <summary>
+		/// Reseeds random generator used for new tiles
+		/// </summary>
+		/// <param name="seed"></param>
+		void Seed(const uint64_t seed);
+
+		/// <summary>
+		/// Adds random tile to game board, drawn from spawn outcomes by their probability
 		/// </summary>
 		void AddRandomTile();
 
+		/// <summary>
+		/// Every possible new tile with its probability, nothing is allocated
+		/// </summary>
+		/// <param name="outcomes">buffer filled from beginning</param>
+		/// <returns>number of outcomes, 0 for full board</returns>
+		std::size_t GetSpawnOutcomes(SpawnOutcomes &outcomes) const;
+
+		/// <summary>
+		/// Sets probability that new tile is 2 and not 4, used by AddRandomTile and spawn outcomes
+		/// </summary>
+		/// <param name="probability">0.0 - 1.0</param>
+		void SetTwoProbability(const double probability);
+
+		double GetTwoProbability() const;
+
+		/// <summary>
+		/// Puts tile with given value to empty cell, search uses it to expand every possible new tile
+		/// </summary>
+		/// <param name="row"></param>
+		/// <param name="col"></param>
+		/// <param name="value"></param>
+		void AddTile(const int8_t row, const int8_t col, const uint16_t value);
+
 		/// <summary>
 		/// Based on direction move tiles on board
 		/// </summary>
 		/// <param name="direction"></param>
-		void MoveBoard(const Direction direction);
+		/// <returns>changes made by move and legal moves of resulting position</returns>
+		MoveResult MoveBoard(const Direction direction);
 
 		/// <summary>
 		/// Set all tiles in Board to 0
@@ -46,6 +177,31 @@ namespace Game2048 {
 		/// </summary>
 		void StartGame();
 
+		/// <summary>
+		/// Replaces board and score with given position
+		/// </summary>
+		/// <param name="board">board of the same size as game</param>
+		/// <param name="score"></param>
+		/// <returns>false if board has different size</returns>
+		bool SetBoard(const GameBoard &board, const uint32_t score);
+
+		/// <summary>
+		/// Replaces board and score with encoded position, board size changes to size of position
+		/// </summary>
+		/// <param name="position">text position of EncodePosition</param>
+		/// <returns>false for malformed position, game is not changed then</returns>
+		bool SetPosition(const std::string &position);
+
+		/// <summary>
+		/// Replaces board and score with position of EncodePositionBinary
+		/// </summary>
+		bool SetPosition(const std::vector<uint8_t> &position);
+
+		/// <summary>
+		/// Text position of EncodePosition
+		/// </summary>
+		std::string GetPosition() const;
+
 		/// <summary>
 		/// Is possible to move board
 		/// </summary>
@@ -58,12 +214,30 @@ namespace Game2048 {
 		/// <param name="direction"></param>
 		/// <returns></returns>
 		bool IsMovePossible(const Direction direction) const;
+
+		/// <summary>
+		/// Legal-move mask of current position, kept up to date by every board change
+		/// </summary>
+		/// <returns>MoveMask bits, 0 means game over</returns>
+		uint8_t GetLegalMoves() const;
 		
 		uint32_t GetScore() const;
 
 		int8_t GetBoardSize() const;
+
+		/// <summary>
+		/// Get biggest tile on board
+		/// </summary>
+		/// <returns></returns>
+		uint16_t GetMaxTile() const;
 		
-		std::vector<std::vector<uint16_t> > GetBoard();
+		const GameBoard &GetBoard() const;
+
+		/// <summary>
+		/// Zobrist hash of board (score is not included), updated with every changed tile
+		/// </summary>
+		/// <returns></returns>
+		uint64_t GetHash() const;
 
 	private:
 
@@ -74,10 +248,39 @@ namespace Game2048 {
 		uint32_t Score = 0;
 
 		// Game board
-		std::vector<std::vector<uint16_t>> Board;
+		GameBoard Board;
+
+		// Generator of new tiles, every game has own so games can run in parallel
+		std::minstd_rand Random;
+
+		// Probability that new tile is 2
+		double TwoProbability = DefaultTwoProbability;
+
+		// Legal moves contributed by every row (first BoardSize items) and column
+		std::pmr::vector<uint8_t> LineMoves;
+
+		// OR of all LineMoves
+		uint8_t LegalMoves = 0;
+
+		// XOR of keys of all tiles
+		uint64_t Hash = 0;
 		
-		bool IsRowSuitable(const int8_t rowIndex) const;
-		bool IsPossibleToAddTile() const;
+		uint64_t GetTileKey(const int8_t row, const int8_t col, const uint16_t value) const;
+
+		/// <summary>
+		/// Changes board size, board is cleared
+		/// </summary>
+		void Resize(const int8_t boardSize);
+
+		/// <summary>
+		/// Changes tile and its part of hash, every board change goes through it
+		/// </summary>
+		void SetTile(const int8_t row, const int8_t col, const uint16_t value);
+
+		uint8_t GetRowMoves(const int8_t row) const;
+		uint8_t GetColumnMoves(const int8_t col) const;
+		void UpdateLegalMoves();
+		void UpdateLegalMoves(const int8_t row, const int8_t col);
 
 	public:
 
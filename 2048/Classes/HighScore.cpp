@@ -2,63 +2,301 @@
 
 #include "HighScore.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
 #include <fstream>
 
 namespace Game2048 {
 
-	std::vector<uint32_t> GetHighScoresFromFile() {
+	int64_t GetPeriodNumber(const int64_t timestamp, const LeaderboardPeriod period) {
+
+		if( period == PERIOD_ALL_TIME ) return 0;
+
+		// shift to local time, so days start at local midnight
+		time_t time = timestamp;
+		tm local {};
+		localtime_r(&time, &local);
+
+		int64_t seconds = timestamp + local.tm_gmtoff;
+		int64_t day = seconds >= 0 ? seconds / 86400 : (seconds - 86399) / 86400;
+
+		if( period == PERIOD_DAY ) return day;
+
+		// 1.1.1970 was Thursday, weeks start on Monday
+		int64_t shifted = day + 3;
+		return shifted >= 0 ? shifted / 7 : (shifted - 6) / 7;
+	}
+
+	namespace {
+
+		// set by GetLeaderboard after loading
+		Leaderboard *SharedLeaderboard = nullptr;
+
+	}
+
+	Leaderboard::Leaderboard(const std::string &file, const std::size_t size) : File(file), Size(size) {}
+
+	Leaderboard::~Leaderboard() {
+
+		if( !Writer.joinable() ) return;
+
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			Stopping = true;
+		}
+
+		Changed.notify_all();
+		Writer.join();
+
+	}
+
+	bool Leaderboard::Load() {
+
+		// records queued before are part of file
+		Flush();
+
+		ResetTopLists();
 
 		// read only stream
 		std::ifstream fileStream;
-		fileStream.open(HighScoreFile);
+		fileStream.open(File);
 
-		if( !fileStream.is_open() ) return {};
+		// no game was finished yet
+		if( !fileStream.is_open() ) return !std::filesystem::exists(File);
 
-		std::vector<uint32_t> highScores;
+		ScoreRecord record;
 
 		std::string line;
 		while( std::getline(fileStream, line) ) {
 
-			try {
-				highScores.push_back(static_cast<uint32_t>(stoll(line)));
-			} catch( const std::invalid_argument ) {
-
+			// broken lines are skipped, rest of file is still usable
+			if( ParseScoreRecord(line, record) ) {
+				Index(record);
 			}
 
 		}
 
 		fileStream.close();
 
-		// sort loaded scores and keep max 10
-		std::sort(highScores.begin(), highScores.end(), std::greater<>());
-		if( highScores.size() > 10 ) {
-			highScores.resize(10);
+		return true;
+	}
+
+	void Leaderboard::Add(const ScoreRecord &record) {
+
+		Index(record);
+
+		std::unique_lock<std::mutex> lock(Mutex);
+		StartWriter();
+
+		// bounded queue, caller waits only if disk is far behind
+		Changed.wait(lock, [this]() { return Pending.size() < LeaderboardQueueSize; });
+
+		Pending.push_back(record);
+		Changed.notify_all();
+
+	}
+
+	void Leaderboard::Clear() {
+
+		ResetTopLists();
+
+		std::lock_guard<std::mutex> lock(Mutex);
+		StartWriter();
+
+		// queued records would be truncated anyway
+		Pending.clear();
+		TruncatePending = true;
+
+		Changed.notify_all();
+
+	}
+
+	bool Leaderboard::Flush() {
+
+		std::unique_lock<std::mutex> lock(Mutex);
+		Changed.wait(lock, [this]() { return Pending.empty() && !TruncatePending && !Writing; });
+
+		bool failed = WriteFailed;
+		WriteFailed = false;
+
+		return !failed;
+	}
+
+	std::vector<ScoreRecord> Leaderboard::GetTop(const int8_t boardSize, const LeaderboardPeriod period, const int64_t now) const {
+
+		if( boardSize < MinBoardSize || boardSize > MaxBoardSize ) return {};
+
+		const TopList &topList = TopLists[boardSize][period];
+
+		// list of other period than asked one has no record from it
+		if( topList.Period != GetPeriodNumber(now, period) ) return {};
+
+		return topList.Records;
+	}
+
+	uint64_t Leaderboard::GetRecordCount() const {
+		return RecordCount;
+	}
+
+	void Leaderboard::ResetTopLists() {
+
+		for( auto &boardLists : TopLists ) {
+			for( TopList &topList : boardLists ) {
+				topList = TopList();
+			}
 		}
 
-		return highScores;
+		RecordCount = 0;
+
 	}
 
-	bool WriteHighScoreToFile(std::vector<uint32_t> highScores) {
+	void Leaderboard::StartWriter() {
 
-		// write only stream
-		std::ofstream fileStream;
+		// mutex is held by caller
+		if( !Writer.joinable() ) {
+			Writer = std::thread(&Leaderboard::WriteRecords, this);
+		}
 
-		// open file and clean its content
-		fileStream.open(HighScoreFile, std::ofstream::out | std::ofstream::trunc);
+	}
 
-		if( !fileStream.is_open() ) return false;
+	void Leaderboard::WriteRecords() {
 
-		// sort scores and save only 10 best
-		std::sort(highScores.begin(), highScores.end(), std::greater<>());
+		std::unique_lock<std::mutex> lock(Mutex);
 
-		for( std::size_t i = 0, len = highScores.size(); i < len && i < 10; i++ ) {
-			fileStream << highScores.at(i) << std::endl;
+		while( true ) {
+
+			Changed.wait(lock, [this]() { return Stopping || TruncatePending || !Pending.empty(); });
+
+			if( Stopping && !TruncatePending && Pending.empty() ) return;
+
+			// everything queued meanwhile is written by one open and close
+			std::vector<ScoreRecord> records(Pending.begin(), Pending.end());
+			bool truncate = TruncatePending;
+
+			Pending.clear();
+			TruncatePending = false;
+			Writing = true;
+
+			lock.unlock();
+			Changed.notify_all();
+
+			bool written = WriteToFile(records, truncate);
+
+			lock.lock();
+
+			Writing = false;
+			WriteFailed |= !written;
+
+			Changed.notify_all();
+
+		}
+
+	}
+
+	bool Leaderboard::WriteToFile(const std::vector<ScoreRecord> &records, const bool truncate) {
+
+		std::string lines;
+		for( const ScoreRecord &record : records ) {
+			lines += FormatScoreRecord(record) + '\n';
 		}
 
+		// appending keeps cost of write independent on number of records
+		std::ofstream fileStream;
+		fileStream.open(File, std::ofstream::out | (truncate ? std::ofstream::trunc : std::ofstream::app));
+
+		if( !fileStream.is_open() ) return false;
+
+		fileStream << lines;
 		fileStream.close();
 
-		return true;
+		return !fileStream.fail();
 	}
 
+	void Leaderboard::Index(const ScoreRecord &record) {
+
+		RecordCount++;
+
+		if( record.BoardSize < MinBoardSize || record.BoardSize > MaxBoardSize ) return;
+
+		for( uint8_t period = PERIOD_DAY; period <= PERIOD_ALL_TIME; period++ ) {
+
+			TopList &topList = TopLists[record.BoardSize][period];
+			int64_t recordPeriod = GetPeriodNumber(record.Timestamp, static_cast<LeaderboardPeriod>(period));
+
+			if( recordPeriod < topList.Period ) continue;
+
+			// new period starts with empty list
+			if( recordPeriod > topList.Period ) {
+				topList.Period = recordPeriod;
+				topList.Records.clear();
+			}
+
+			if( topList.Records.size() >= Size && record.Score <= topList.Records.back().Score ) continue;
+
+			// equal scores keep order in which they were reached
+			auto position = std::upper_bound(topList.Records.begin(), topList.Records.end(), record, [](const ScoreRecord &a, const ScoreRecord &b) {
+				return a.Score > b.Score;
+			});
+
+			topList.Records.insert(position, record);
+
+			if( topList.Records.size() > Size ) {
+				topList.Records.pop_back();
+			}
+
+		}
+
+	}
+
+	Leaderboard &GetLeaderboard() {
+
+		static Leaderboard leaderboard;
+
+		if( SharedLeaderboard == nullptr ) {
+			leaderboard.Load();
+			SharedLeaderboard = &leaderboard;
+		}
+
+		return leaderboard;
+	}
+
+	void FlushLeaderboard() {
+
+		if( SharedLeaderboard != nullptr ) {
+			SharedLeaderboard->Flush();
+		}
+
+	}
+
+	std::string FormatScoreRecord(const ScoreRecord &record) {
+
+		char line[96];
+		snprintf(line, sizeof(line), "%d %u %u %u %u %lld", record.BoardSize, record.Score, record.MaxTile, record.Moves,
+			record.DurationSeconds, static_cast<long long>(record.Timestamp));
+
+		return line;
+	}
+
+	bool ParseScoreRecord(const std::string &line, ScoreRecord &record) {
+
+		int boardSize;
+		unsigned score, maxTile, moves, duration;
+		long long timestamp;
+
+		if( sscanf(line.c_str(), "%d %u %u %u %u %lld", &boardSize, &score, &maxTile, &moves, &duration, &timestamp) != 6 ) {
+			return false;
+		}
+
+		record.BoardSize = boardSize;
+		record.Score = score;
+		record.MaxTile = maxTile;
+		record.Moves = moves;
+		record.DurationSeconds = duration;
+		record.Timestamp = timestamp;
+
+		return true;
+	}
 
-}
\ No newline at end of file
+}
@@ -4,23 +4,166 @@
 
 #include <vector>
 #include <cinttypes>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
+
+#include "Game.h"
 
 namespace Game2048 {
 
-	const std::string HighScoreFile = "score.txt";
+	// one record per line, new records are appended
+	const std::string HighScoreFile = "leaderboard.txt";
+
+	// Length of every top list
+	const std::size_t LeaderboardSize = 10;
+
+	// Records waiting for writer thread, adding to full queue waits
+	const std::size_t LeaderboardQueueSize = 1024;
+
+	/// <summary>
+	/// Result of one finished game
+	/// </summary>
+	struct ScoreRecord {
+
+		int8_t BoardSize = 0;
+		uint32_t Score = 0;
+		uint16_t MaxTile = 0;
+		uint32_t Moves = 0;
+		uint32_t DurationSeconds = 0;
+
+		// unix time of game end
+		int64_t Timestamp = 0;
+
+	};
+
+	enum LeaderboardPeriod : uint8_t {
+		PERIOD_DAY, PERIOD_WEEK, PERIOD_ALL_TIME
+	};
+
+	const std::vector<std::string> PeriodNames {
+		"today",
+		"this week",
+		"all time"
+	};
+
+	/// <summary>
+	/// Number of local day or week (starting on Monday) containing given time, 0 for all time
+	/// </summary>
+	int64_t GetPeriodNumber(const int64_t timestamp, const LeaderboardPeriod period);
+
+	/// <summary>
+	/// Records of finished games with top lists per board size and period. Lists are updated on every
+	/// insert, so query costs only length of list however many records file has. File is written
+	/// by background thread, all methods except Flush have to be called from one thread.
+	/// </summary>
+	class Leaderboard {
+
+	public:
+
+		Leaderboard(const std::string &file = HighScoreFile, const std::size_t size = LeaderboardSize);
+
+		/// <summary>
+		/// Writes queued records and stops writer thread
+		/// </summary>
+		~Leaderboard();
+
+		Leaderboard(const Leaderboard &) = delete;
+		Leaderboard &operator=(const Leaderboard &) = delete;
+
+		/// <summary>
+		/// Reads all records of file, missing file is empty leaderboard
+		/// </summary>
+		/// <returns>false if file exists but cannot be read</returns>
+		bool Load();
+
+		/// <summary>
+		/// Adds record to top lists and queues its append to file
+		/// </summary>
+		/// <param name="record"></param>
+		void Add(const ScoreRecord &record);
+
+		/// <summary>
+		/// Removes all records from top lists and queues truncation of file
+		/// </summary>
+		void Clear();
+
+		/// <summary>
+		/// Waits until everything queued is written
+		/// </summary>
+		/// <returns>false if some write failed since last flush</returns>
+		bool Flush();
+
+		/// <summary>
+		/// Best records of board size in period containing given time, sorted from highest score
+		/// </summary>
+		/// <param name="boardSize"></param>
+		/// <param name="period"></param>
+		/// <param name="now">unix time</param>
+		/// <returns></returns>
+		std::vector<ScoreRecord> GetTop(const int8_t boardSize, const LeaderboardPeriod period, const int64_t now) const;
+
+		uint64_t GetRecordCount() const;
+
+	private:
+
+		/// <summary>
+		/// Sorted top list of one period, older periods are forgotten
+		/// </summary>
+		struct TopList {
+
+			int64_t Period = INT64_MIN;
+			std::vector<ScoreRecord> Records;
+
+		};
+
+		void Index(const ScoreRecord &record);
+		void ResetTopLists();
+
+		void StartWriter();
+		void WriteRecords();
+		bool WriteToFile(const std::vector<ScoreRecord> &records, const bool truncate);
+
+		std::string File;
+		std::size_t Size;
+
+		uint64_t RecordCount = 0;
+
+		TopList TopLists[MaxBoardSize + 1][PERIOD_ALL_TIME + 1];
+
+		// state shared with writer thread
+		std::thread Writer;
+		std::mutex Mutex;
+		std::condition_variable Changed;
+		std::deque<ScoreRecord> Pending;
+		bool TruncatePending = false;
+		bool Writing = false;
+		bool WriteFailed = false;
+		bool Stopping = false;
+
+	};
+
+	/// <summary>
+	/// Leaderboard of interactive game, loaded on first use
+	/// </summary>
+	Leaderboard &GetLeaderboard();
+
+	/// <summary>
+	/// Flushes leaderboard of interactive game if it was used
+	/// </summary>
+	void FlushLeaderboard();
 
 	/// <summary>
-	/// Get top 10 scores from high score file
+	/// Writes record as one line of leaderboard file
 	/// </summary>
-	/// <returns></returns>
-	std::vector<uint32_t> GetHighScoresFromFile();
+	std::string FormatScoreRecord(const ScoreRecord &record);
 
 	/// <summary>
-	/// Save top 10 scores from high score file
+	/// Reads record from one line of leaderboard file
 	/// </summary>
-	/// <param name="highScores"></param>
-	/// <returns></returns>
-	bool WriteHighScoreToFile(std::vector<uint32_t> highScores);
+	/// <returns>false for malformed line</returns>
+	bool ParseScoreRecord(const std::string &line, ScoreRecord &record);
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,224 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "LiveFeed.h"
+
+#include <bit>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Game2048 {
+
+	namespace {
+
+		std::size_t GetMappedSize(const uint32_t capacity) {
+			return sizeof(LiveFeedHeader) + sizeof(LiveFeedEntry) * capacity;
+		}
+
+	}
+
+	GameBoard LiveFeedState::GetBoard() const {
+
+		GameBoard board(BoardSize, std::pmr::vector<uint16_t>(BoardSize));
+
+		for( int cell = 0; cell < BoardSize * BoardSize; cell++ ) {
+
+			uint8_t exponent = (Board[cell / 16] >> (4 * (cell % 16))) & 0xF;
+			board[cell / BoardSize][cell % BoardSize] = exponent ? 1 << exponent : 0;
+
+		}
+
+		return board;
+	}
+
+	LiveFeed::~LiveFeed() {
+		Close();
+	}
+
+	bool LiveFeed::Create(const std::string &name, const uint32_t capacity) {
+
+		Close();
+
+		uint32_t slots = std::bit_ceil(std::max(capacity, 2u));
+
+		// old feed of the same name may still be mapped by readers, they keep old memory
+		shm_unlink(name.c_str());
+
+		int descriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+		if( descriptor < 0 ) return false;
+
+		std::size_t size = GetMappedSize(slots);
+
+		void *memory = MAP_FAILED;
+		if( ftruncate(descriptor, size) == 0 ) {
+			memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+		}
+
+		close(descriptor);
+
+		if( memory == MAP_FAILED ) {
+			shm_unlink(name.c_str());
+			return false;
+		}
+
+		// new object is zero filled, header is completed before magic tells readers it is ready
+		Header = static_cast<LiveFeedHeader *>(memory);
+		Entries = reinterpret_cast<LiveFeedEntry *>(Header + 1);
+
+		Header->Version = LiveFeedVersion;
+		Header->Capacity = slots;
+		Header->EntrySize = sizeof(LiveFeedEntry);
+		std::atomic_thread_fence(std::memory_order_release);
+		std::memcpy(Header->Magic, LiveFeedMagic, sizeof(LiveFeedMagic));
+
+		Name = name;
+		MappedSize = size;
+		Published = 0;
+
+		return true;
+	}
+
+	void LiveFeed::Close() {
+
+		if( !Header ) return;
+
+		Header->Closed.store(1, std::memory_order_release);
+
+		munmap(Header, MappedSize);
+		shm_unlink(Name.c_str());
+
+		Header = nullptr;
+		Entries = nullptr;
+
+	}
+
+	bool LiveFeed::IsOpen() const {
+		return Header != nullptr;
+	}
+
+	void LiveFeed::Publish(const Game &game, const uint32_t move) {
+
+		if( !Header ) return;
+
+		uint64_t board[2] {};
+		int8_t boardSize = game.GetBoardSize();
+
+		for( int cell = 0; cell < boardSize * boardSize; cell++ ) {
+
+			uint16_t value = game.GetBoard()[cell / boardSize][cell % boardSize];
+			uint64_t exponent = value ? std::countr_zero(value) : 0;
+
+			board[cell / 16] |= exponent << (4 * (cell % 16));
+
+		}
+
+		uint64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+		LiveFeedEntry &entry = Entries[Published & (Header->Capacity - 1)];
+
+		// odd sequence tells readers entry is being changed
+		entry.Sequence.store(2 * Published + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		entry.Board[0].store(board[0], std::memory_order_relaxed);
+		entry.Board[1].store(board[1], std::memory_order_relaxed);
+		entry.Timestamp.store(timestamp, std::memory_order_relaxed);
+		entry.Score.store(game.GetScore(), std::memory_order_relaxed);
+		entry.Move.store(move, std::memory_order_relaxed);
+		entry.BoardSize.store(boardSize, std::memory_order_relaxed);
+
+		entry.Sequence.store(2 * Published + 2, std::memory_order_release);
+
+		Published++;
+		Header->WriteIndex.store(Published, std::memory_order_release);
+
+	}
+
+	LiveFeedReader::~LiveFeedReader() {
+
+		if( Header ) {
+			munmap(const_cast<LiveFeedHeader *>(Header), MappedSize);
+		}
+
+	}
+
+	bool LiveFeedReader::Open(const std::string &name) {
+
+		int descriptor = shm_open(name.c_str(), O_RDONLY, 0);
+		if( descriptor < 0 ) return false;
+
+		struct stat status;
+		void *memory = MAP_FAILED;
+
+		if( fstat(descriptor, &status) == 0 && (std::size_t) status.st_size >= sizeof(LiveFeedHeader) ) {
+			memory = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+		}
+
+		close(descriptor);
+
+		if( memory == MAP_FAILED ) return false;
+
+		const LiveFeedHeader *header = static_cast<const LiveFeedHeader *>(memory);
+
+		bool valid = std::memcmp(header->Magic, LiveFeedMagic, sizeof(LiveFeedMagic)) == 0;
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		valid = valid && header->Version == LiveFeedVersion && header->EntrySize == sizeof(LiveFeedEntry) &&
+			std::has_single_bit(header->Capacity) && GetMappedSize(header->Capacity) <= (std::size_t) status.st_size;
+
+		if( !valid ) {
+			munmap(memory, status.st_size);
+			return false;
+		}
+
+		Header = header;
+		Entries = reinterpret_cast<const LiveFeedEntry *>(header + 1);
+		MappedSize = status.st_size;
+
+		return true;
+	}
+
+	uint64_t LiveFeedReader::GetWriteIndex() const {
+		return Header->WriteIndex.load(std::memory_order_acquire);
+	}
+
+	uint32_t LiveFeedReader::GetCapacity() const {
+		return Header->Capacity;
+	}
+
+	bool LiveFeedReader::IsClosed() const {
+		return Header->Closed.load(std::memory_order_acquire) != 0;
+	}
+
+	bool LiveFeedReader::Read(const uint64_t index, LiveFeedState &state) const {
+
+		const LiveFeedEntry &entry = Entries[index & (Header->Capacity - 1)];
+
+		uint64_t sequence = entry.Sequence.load(std::memory_order_acquire);
+		if( sequence != 2 * index + 2 ) return false;
+
+		state.Index = index;
+		state.Board[0] = entry.Board[0].load(std::memory_order_relaxed);
+		state.Board[1] = entry.Board[1].load(std::memory_order_relaxed);
+		state.Timestamp = entry.Timestamp.load(std::memory_order_relaxed);
+		state.Score = entry.Score.load(std::memory_order_relaxed);
+		state.Move = entry.Move.load(std::memory_order_relaxed);
+		state.BoardSize = entry.BoardSize.load(std::memory_order_relaxed);
+
+		// producer could overwrite entry meanwhile, then sequence changed
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		return entry.Sequence.load(std::memory_order_relaxed) == sequence;
+	}
+
+	LiveFeed &GetLiveFeed() {
+
+		static LiveFeed feed;
+		return feed;
+	}
+
+}
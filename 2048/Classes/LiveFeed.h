@@ -0,0 +1,181 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "Game.h"
+
+namespace Game2048 {
+
+	/// <summary>
+	/// Beginning of shared memory of feed, Capacity entries follow it
+	/// </summary>
+	struct alignas(64) LiveFeedHeader {
+
+		char Magic[8];
+		uint32_t Version;
+
+		// Power of two
+		uint32_t Capacity;
+
+		uint32_t EntrySize;
+
+		// Set when producer is destroyed, readers finish remaining entries then
+		std::atomic<uint32_t> Closed;
+
+		// Number of published entries, entry i is in slot i % Capacity
+		alignas(64) std::atomic<uint64_t> WriteIndex;
+
+	};
+
+	/// <summary>
+	/// State after one move. Fields are atomics only so concurrent access from other processes
+	/// is defined, they are written and read relaxed inside sequence lock of entry.
+	/// </summary>
+	struct alignas(64) LiveFeedEntry {
+
+		// 2i + 1 while entry i is written, 2i + 2 when it is complete
+		std::atomic<uint64_t> Sequence;
+
+		// Tile exponents, cell r * size + c is nibble at bits 4 * cell (cells 16+ in second word)
+		std::atomic<uint64_t> Board[2];
+
+		// Nanoseconds since epoch
+		std::atomic<uint64_t> Timestamp;
+
+		std::atomic<uint32_t> Score;
+
+		// Moves of current game, new game starts again from 1
+		std::atomic<uint32_t> Move;
+
+		std::atomic<int8_t> BoardSize;
+
+	};
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+		"feed in shared memory needs address-free atomics");
+
+	/// <summary>
+	/// Consistent copy of entry taken by reader
+	/// </summary>
+	struct LiveFeedState {
+
+		uint64_t Index = 0;
+		uint64_t Board[2] {};
+		uint64_t Timestamp = 0;
+		uint32_t Score = 0;
+		uint32_t Move = 0;
+		int8_t BoardSize = 0;
+
+		/// <summary>
+		/// Unpacks board to tile values
+		/// </summary>
+		GameBoard GetBoard() const;
+
+	};
+
+	const char LiveFeedMagic[8] { '2', '0', '4', '8', 'F', 'E', 'E', 'D' };
+	const uint32_t LiveFeedVersion = 1;
+
+	const uint32_t DefaultLiveFeedCapacity = 4096;
+
+	/// <summary>
+	/// Single producer ring buffer in POSIX shared memory. Publishing is few stores without
+	/// syscalls or locks and never waits for readers, slow reader is overtaken and notices it
+	/// by sequence of entry.
+	/// </summary>
+	class LiveFeed {
+
+	public:
+
+		LiveFeed() = default;
+		~LiveFeed();
+
+		LiveFeed(const LiveFeed &) = delete;
+		LiveFeed &operator=(const LiveFeed &) = delete;
+
+		/// <summary>
+		/// Creates (or replaces) shared memory object, name is like "/2048-feed"
+		/// </summary>
+		/// <param name="name"></param>
+		/// <param name="capacity">rounded up to power of two</param>
+		/// <returns>false if shared memory cannot be created</returns>
+		bool Create(const std::string &name, const uint32_t capacity = DefaultLiveFeedCapacity);
+
+		/// <summary>
+		/// Marks feed closed and removes its name, mapped readers keep their view
+		/// </summary>
+		void Close();
+
+		bool IsOpen() const;
+
+		/// <summary>
+		/// Publishes position of game after move, does nothing if feed is not open
+		/// </summary>
+		/// <param name="game"></param>
+		/// <param name="move">moves of game so far</param>
+		void Publish(const Game &game, const uint32_t move);
+
+	private:
+
+		std::string Name;
+
+		LiveFeedHeader *Header = nullptr;
+		LiveFeedEntry *Entries = nullptr;
+
+		std::size_t MappedSize = 0;
+
+		// Producer is the only writer, its own count needs no atomic read
+		uint64_t Published = 0;
+
+	};
+
+	/// <summary>
+	/// Read-only view of feed of other process, entries are read in place from shared memory
+	/// </summary>
+	class LiveFeedReader {
+
+	public:
+
+		LiveFeedReader() = default;
+		~LiveFeedReader();
+
+		LiveFeedReader(const LiveFeedReader &) = delete;
+		LiveFeedReader &operator=(const LiveFeedReader &) = delete;
+
+		/// <returns>false for missing or incompatible feed</returns>
+		bool Open(const std::string &name);
+
+		/// <summary>
+		/// Number of entries published so far
+		/// </summary>
+		uint64_t GetWriteIndex() const;
+
+		uint32_t GetCapacity() const;
+
+		bool IsClosed() const;
+
+		/// <summary>
+		/// Reads entry with given index
+		/// </summary>
+		/// <returns>false if entry is not published yet or was already overwritten</returns>
+		bool Read(const uint64_t index, LiveFeedState &state) const;
+
+	private:
+
+		const LiveFeedHeader *Header = nullptr;
+		const LiveFeedEntry *Entries = nullptr;
+
+		std::size_t MappedSize = 0;
+
+	};
+
+	/// <summary>
+	/// Feed of interactive game, open only if play command was given --feed
+	/// </summary>
+	LiveFeed &GetLiveFeed();
+
+}
@@ -0,0 +1,292 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "OpeningBook.h"
+#include "Evaluator.h"
+#include "PackedBoard.h"
+#include "Search.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Game2048 {
+
+	namespace {
+
+		/// <summary>
+		/// Canonical boards with a legal move reachable within depth moves from starting positions
+		/// </summary>
+		std::vector<PackedBoard> EnumeratePositions(const int8_t boardSize, const int depth) {
+
+			int cells = boardSize * boardSize;
+
+			std::unordered_set<PackedBoard> known;
+			std::vector<PackedBoard> level;
+
+			auto add = [&](const PackedBoard board, std::vector<PackedBoard> &next) {
+
+				Symmetry symmetry;
+				PackedBoard canonical = CanonicalizeBoard(board, boardSize, symmetry);
+
+				if( known.insert(canonical).second ) {
+					next.push_back(canonical);
+				}
+
+			};
+
+			// every placement of two tiles of StartGame, exponents 1 and 2 are tiles 2 and 4
+			for( int first = 0; first < cells; first++ ) {
+				for( int second = first + 1; second < cells; second++ ) {
+					for( PackedBoard firstTile : { 1, 2 } ) {
+						for( PackedBoard secondTile : { 1, 2 } ) {
+							add((firstTile << (first * 4)) | (secondTile << (second * 4)), level);
+						}
+					}
+				}
+			}
+
+			for( int move = 0; move < depth; move++ ) {
+
+				std::vector<PackedBoard> next;
+
+				for( PackedBoard board : level ) {
+
+					uint8_t legalMoves = GetPackedLegalMoves(board, boardSize);
+
+					for( Direction direction : Directions ) {
+
+						if( !(legalMoves & DirectionMask(direction)) ) continue;
+
+						PackedBoard moved = board;
+						MovePackedBoard(moved, boardSize, direction);
+
+						SpawnOutcomes outcomes;
+						std::size_t count = ListSpawnOutcomes(GetPackedEmptyCells(moved, boardSize), boardSize, DefaultTwoProbability, outcomes);
+
+						for( std::size_t i = 0; i < count; i++ ) {
+							add(SpawnPackedTile(moved, boardSize, outcomes[i]), next);
+						}
+
+					}
+
+				}
+
+				level = std::move(next);
+
+			}
+
+			std::vector<PackedBoard> positions;
+
+			for( PackedBoard board : known ) {
+				if( GetPackedLegalMoves(board, boardSize) != 0 ) positions.push_back(board);
+			}
+
+			std::sort(positions.begin(), positions.end());
+
+			return positions;
+		}
+
+		OpeningBook DefaultBooks[MaxBoardSize + 1];
+		std::once_flag DefaultBooksOpened[MaxBoardSize + 1];
+
+	}
+
+	std::string GetOpeningBookFile(const int8_t boardSize) {
+		return "book" + std::to_string(boardSize) + ".bin";
+	}
+
+	OpeningBook::~OpeningBook() {
+		Close();
+	}
+
+	bool OpeningBook::Open(const std::string &file) {
+
+		Close();
+
+		int descriptor = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+		if( descriptor < 0 ) return false;
+
+		struct stat status;
+		if( fstat(descriptor, &status) < 0 || status.st_size < (off_t) sizeof(OpeningBookHeader) ) {
+			close(descriptor);
+			return false;
+		}
+
+		void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+		// mapping stays valid after descriptor is closed
+		close(descriptor);
+
+		if( mapping == MAP_FAILED ) return false;
+
+		Mapping = mapping;
+		MappingSize = status.st_size;
+
+		Header = static_cast<const OpeningBookHeader *>(Mapping);
+		Entries = reinterpret_cast<const OpeningBookEntry *>(static_cast<const char *>(Mapping) + sizeof(OpeningBookHeader));
+
+		bool valid = memcmp(Header->Magic, OpeningBookMagic, sizeof(OpeningBookMagic)) == 0 && Header->Version == OpeningBookVersion
+			&& IsPackedBoardSize(Header->BoardSize)
+			&& Header->EntryCount == (MappingSize - sizeof(OpeningBookHeader)) / sizeof(OpeningBookEntry);
+
+		if( !valid ) {
+			Close();
+			return false;
+		}
+
+		// lookups jump around whole table
+		madvise(Mapping, MappingSize, MADV_RANDOM);
+
+		return true;
+	}
+
+	void OpeningBook::Close() {
+
+		if( Mapping != nullptr ) {
+			munmap(Mapping, MappingSize);
+		}
+
+		Mapping = nullptr;
+		MappingSize = 0;
+		Header = nullptr;
+		Entries = nullptr;
+
+	}
+
+	bool OpeningBook::IsOpen() const {
+		return Mapping != nullptr;
+	}
+
+	int8_t OpeningBook::GetBoardSize() const {
+		return Header ? Header->BoardSize : 0;
+	}
+
+	uint64_t OpeningBook::GetEntryCount() const {
+		return Header ? Header->EntryCount : 0;
+	}
+
+	bool OpeningBook::Lookup(const Game &game, Direction &move, float &value, int &depth) const {
+
+		if( !IsOpen() || game.GetBoardSize() != Header->BoardSize ) return false;
+
+		// book values are expectations over spawns with default split of 2 and 4
+		if( game.GetTwoProbability() != DefaultTwoProbability ) return false;
+
+		Symmetry symmetry;
+		PackedBoard key = CanonicalizeBoard(PackBoard(game.GetBoard()), game.GetBoardSize(), symmetry);
+
+		const OpeningBookEntry *end = Entries + Header->EntryCount;
+		const OpeningBookEntry *entry = std::lower_bound(Entries, end, key, [](const OpeningBookEntry &entry, const uint64_t key) {
+			return entry.Key < key;
+		});
+
+		if( entry == end || entry->Key != key || entry->Move >= 4 ) return false;
+
+		move = TransformDirection(Directions[entry->Move], InverseSymmetry(symmetry));
+		value = entry->Value;
+		depth = entry->Depth;
+
+		return true;
+	}
+
+	const OpeningBook *GetDefaultOpeningBook(const int8_t boardSize) {
+
+		if( boardSize < 0 || boardSize > MaxBoardSize ) return nullptr;
+
+		std::call_once(DefaultBooksOpened[boardSize], [boardSize]() {
+			DefaultBooks[boardSize].Open(GetOpeningBookFile(boardSize));
+		});
+
+		const OpeningBook &book = DefaultBooks[boardSize];
+
+		return book.IsOpen() && book.GetBoardSize() == boardSize ? &book : nullptr;
+	}
+
+	bool BuildOpeningBook(const OpeningBookConfig &config, const std::string &file, OpeningBookReport &report) {
+
+		if( !IsPackedBoardSize(config.BoardSize) ) return false;
+
+		auto start = std::chrono::steady_clock::now();
+
+		std::vector<PackedBoard> positions = EnumeratePositions(config.BoardSize, config.Depth);
+		std::vector<OpeningBookEntry> entries(positions.size());
+
+		// fixed depth without deadline, book does not depend on machine speed
+		SearchConfig searchConfig;
+		searchConfig.MaxDepth = config.SearchDepth;
+		searchConfig.TimeBudget = std::chrono::hours(24);
+
+		std::atomic<std::size_t> next = 0;
+		std::vector<std::thread> threads;
+
+		for( unsigned t = 0; t < std::max(1u, config.Threads); t++ ) {
+
+			threads.emplace_back([&]() {
+
+				ExpectimaxSearch search(GetDefaultEvaluator(), searchConfig);
+				Game game(config.BoardSize, 0);
+
+				std::size_t i;
+				while( (i = next.fetch_add(1)) < positions.size() ) {
+
+					game.SetBoard(UnpackBoard(positions[i], config.BoardSize), 0);
+					SearchResult result = search.Search(game);
+
+					OpeningBookEntry &entry = entries[i];
+					entry.Key = positions[i];
+					entry.Value = result.Value;
+					entry.Move = std::find(std::begin(Directions), std::end(Directions), result.Move) - std::begin(Directions);
+					entry.Depth = result.Depth;
+					entry.Reserved = 0;
+
+				}
+
+			});
+
+		}
+
+		for( std::thread &thread : threads ) {
+			thread.join();
+		}
+
+		OpeningBookHeader header {};
+		memcpy(header.Magic, OpeningBookMagic, sizeof(OpeningBookMagic));
+		header.Version = OpeningBookVersion;
+		header.BoardSize = config.BoardSize;
+		header.EntryCount = entries.size();
+
+		// book is replaced at once, processes which mapped old one keep reading it
+		std::string temporaryFile = file + ".tmp";
+
+		// positions were sorted, so are entries
+		std::ofstream fileStream(temporaryFile, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+		if( !fileStream.is_open() ) return false;
+
+		fileStream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		fileStream.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(OpeningBookEntry));
+		fileStream.close();
+
+		if( fileStream.fail() || std::rename(temporaryFile.c_str(), file.c_str()) != 0 ) {
+			std::remove(temporaryFile.c_str());
+			return false;
+		}
+
+		report.Positions = entries.size();
+		report.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return true;
+	}
+
+}
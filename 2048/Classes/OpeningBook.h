@@ -0,0 +1,135 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Game.h"
+
+namespace Game2048 {
+
+	/// <summary>
+	/// File of default opening book of board size, e.g. book4.bin
+	/// </summary>
+	std::string GetOpeningBookFile(const int8_t boardSize);
+
+	/// <summary>
+	/// Beginning of book file, entries sorted by key follow it
+	/// </summary>
+	struct OpeningBookHeader {
+
+		char Magic[8];
+		uint32_t Version;
+		int32_t BoardSize;
+		uint64_t EntryCount;
+
+	};
+
+	struct OpeningBookEntry {
+
+		// Canonical packed board
+		uint64_t Key;
+
+		// Expected evaluation after Move
+		float Value;
+
+		// Index to Directions, move on canonical board
+		uint8_t Move;
+
+		// Search depth of Value
+		uint8_t Depth;
+
+		uint16_t Reserved;
+
+	};
+
+	const char OpeningBookMagic[8] { '2', '0', '4', '8', 'B', 'O', 'O', 'K' };
+	const uint32_t OpeningBookVersion = 1;
+
+	/// <summary>
+	/// Read-only book of early positions mapped into memory, lookup is binary search over file
+	/// without reading it first. Only boards with packed representation (3x3, 4x4) are supported.
+	/// </summary>
+	class OpeningBook {
+
+	public:
+
+		OpeningBook() = default;
+		~OpeningBook();
+
+		OpeningBook(const OpeningBook &) = delete;
+		OpeningBook &operator=(const OpeningBook &) = delete;
+
+		/// <summary>
+		/// Maps book file, previous one is closed
+		/// </summary>
+		/// <param name="file"></param>
+		/// <returns>false if file is missing or it is not valid book</returns>
+		bool Open(const std::string &file);
+
+		void Close();
+
+		bool IsOpen() const;
+		int8_t GetBoardSize() const;
+		uint64_t GetEntryCount() const;
+
+		/// <summary>
+		/// Finds best move of position
+		/// </summary>
+		/// <param name="game"></param>
+		/// <param name="move">move on board of game</param>
+		/// <param name="value"></param>
+		/// <param name="depth">search depth of book entry</param>
+		/// <returns>false if position is not in book or game spawns 2 with other than DefaultTwoProbability</returns>
+		bool Lookup(const Game &game, Direction &move, float &value, int &depth) const;
+
+	private:
+
+		void *Mapping = nullptr;
+		std::size_t MappingSize = 0;
+
+		const OpeningBookHeader *Header = nullptr;
+		const OpeningBookEntry *Entries = nullptr;
+
+	};
+
+	/// <summary>
+	/// Book from GetOpeningBookFile opened on first use, may be called from any thread
+	/// </summary>
+	/// <param name="boardSize"></param>
+	/// <returns>nullptr if there is no valid book for board size</returns>
+	const OpeningBook *GetDefaultOpeningBook(const int8_t boardSize);
+
+	struct OpeningBookConfig {
+
+		int8_t BoardSize = 4;
+
+		// Player moves from starting positions included in book
+		int Depth = 2;
+
+		// Depth of expectimax search of every position
+		int SearchDepth = 3;
+
+		unsigned Threads = 1;
+
+	};
+
+	struct OpeningBookReport {
+
+		uint64_t Positions = 0;
+		double Seconds = 0;
+
+	};
+
+	/// <summary>
+	/// Enumerates canonical positions reachable from every starting position (two tiles on empty board),
+	/// searches them in parallel and writes sorted table to file
+	/// </summary>
+	/// <param name="config"></param>
+	/// <param name="file"></param>
+	/// <param name="report"></param>
+	/// <returns>false if board size is not supported or file cannot be written</returns>
+	bool BuildOpeningBook(const OpeningBookConfig &config, const std::string &file, OpeningBookReport &report);
+
+}
@@ -0,0 +1,434 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "PackedBoard.h"
+
+#include <array>
+#include <bit>
+
+namespace Game2048 {
+
+	namespace {
+
+		// Lowest bit of every nibble
+		const PackedBoard NibbleBits = 0x1111111111111111;
+
+		/// <summary>
+		/// Results of Game::MoveBoard rules applied on every possible packed row
+		/// (4096 rows of 3x3 board, 65536 rows of 4x4 board)
+		/// </summary>
+		template<int Size>
+		struct RowTables {
+
+			static constexpr std::size_t RowCount = std::size_t(1) << (4 * Size);
+
+			std::array<uint16_t, RowCount> MovedLow {};
+			std::array<uint16_t, RowCount> MovedHigh {};
+			std::array<uint32_t, RowCount> Score {};
+			std::array<uint8_t, RowCount> Merges {};
+
+		};
+
+		template<int Size>
+		consteval RowTables<Size> BuildRowTables() {
+
+			RowTables<Size> tables;
+
+			for( std::size_t row = 0; row < tables.RowCount; row++ ) {
+
+				uint8_t tiles[4] = {};
+				for( int i = 0; i < Size; i++ ) {
+					tiles[i] = (row >> (4 * i)) & 0xF;
+				}
+
+				// merges pair tiles from first one regardless of direction, like Game::MoveBoard
+				uint32_t score = 0;
+				uint8_t merges = 0;
+
+				for( int i = 0; i < Size; i++ ) {
+
+					if( tiles[i] == 0 ) continue;
+
+					for( int j = i + 1; j < Size; j++ ) {
+
+						if( tiles[j] == 0 ) continue;
+						if( tiles[j] != tiles[i] ) break;
+
+						// 32768 + 32768 overflows uint16_t tile of Game to empty tile worth nothing
+						tiles[i] = tiles[i] == 15 ? 0 : tiles[i] + 1;
+						tiles[j] = 0;
+
+						score += tiles[i] != 0 ? 1u << tiles[i] : 0;
+						merges++;
+						break;
+
+					}
+
+				}
+
+				uint16_t movedLow = 0;
+				uint16_t movedHigh = 0;
+
+				for( int i = 0, low = 0, high = Size - 1; i < Size; i++ ) {
+
+					if( tiles[i] != 0 ) {
+						movedLow |= tiles[i] << (4 * low++);
+					}
+
+					if( tiles[Size - 1 - i] != 0 ) {
+						movedHigh |= tiles[Size - 1 - i] << (4 * high--);
+					}
+
+				}
+
+				tables.MovedLow[row] = movedLow;
+				tables.MovedHigh[row] = movedHigh;
+				tables.Score[row] = score;
+				tables.Merges[row] = merges;
+
+			}
+
+			return tables;
+		}
+
+		// computed by compiler and stored read-only in binary, process start does no work for them
+		template<int Size>
+		constexpr RowTables<Size> PrecomputedRowTables = BuildRowTables<Size>();
+
+		template<int Size>
+		const RowTables<Size> &GetRowTables() {
+			return PrecomputedRowTables<Size>;
+		}
+
+		template<int Size>
+		PackedBoard Transpose(const PackedBoard board);
+
+		template<>
+		PackedBoard Transpose<3>(const PackedBoard board) {
+
+			// swap tiles mirrored by main diagonal: 1 <-> 3, 5 <-> 7 and 2 <-> 6
+			PackedBoard swap = (board ^ (board >> 8)) & 0x0000000000F000F0;
+			PackedBoard result = board ^ swap ^ (swap << 8);
+
+			swap = (result ^ (result >> 16)) & 0x0000000000000F00;
+			return result ^ swap ^ (swap << 16);
+
+		}
+
+		template<>
+		PackedBoard Transpose<4>(const PackedBoard board) {
+
+			PackedBoard a1 = board & 0xF0F00F0FF0F00F0F;
+			PackedBoard a2 = board & 0x0000F0F00000F0F0;
+			PackedBoard a3 = board & 0x0F0F00000F0F0000;
+			PackedBoard a = a1 | (a2 << 12) | (a3 >> 12);
+
+			PackedBoard b1 = a & 0xFF00FF0000FF00FF;
+			PackedBoard b2 = a & 0x00FF00FF00000000;
+			PackedBoard b3 = a & 0x00000000FF00FF00;
+
+			return b1 | (b2 >> 24) | (b3 << 24);
+
+		}
+
+		template<int Size>
+		PackedBoard MirrorColumns(const PackedBoard board);
+
+		template<>
+		PackedBoard MirrorColumns<3>(const PackedBoard board) {
+			return ((board & 0x00F00F00F) << 8) | (board & 0x0F00F00F0) | ((board & 0xF00F00F00) >> 8);
+		}
+
+		template<>
+		PackedBoard MirrorColumns<4>(const PackedBoard board) {
+			return ((board & 0x000F000F000F000F) << 12) | ((board & 0x00F000F000F000F0) << 4)
+				| ((board & 0x0F000F000F000F00) >> 4) | ((board & 0xF000F000F000F000) >> 12);
+		}
+
+		template<int Size>
+		PackedBoard MirrorRows(const PackedBoard board);
+
+		template<>
+		PackedBoard MirrorRows<3>(const PackedBoard board) {
+			return ((board & 0xFFF) << 24) | (board & 0xFFF000) | ((board >> 24) & 0xFFF);
+		}
+
+		template<>
+		PackedBoard MirrorRows<4>(const PackedBoard board) {
+			return (board << 48) | ((board & 0xFFFF0000) << 16) | ((board >> 16) & 0xFFFF0000) | (board >> 48);
+		}
+
+		template<int Size>
+		PackedBoard Transform(PackedBoard board, const Symmetry symmetry) {
+
+			if( symmetry & SYMMETRY_TRANSPOSE ) board = Transpose<Size>(board);
+			if( symmetry & SYMMETRY_MIRROR_COLUMNS ) board = MirrorColumns<Size>(board);
+			if( symmetry & SYMMETRY_MIRROR_ROWS ) board = MirrorRows<Size>(board);
+
+			return board;
+		}
+
+		template<int Size>
+		PackedBoard Canonicalize(const PackedBoard board, Symmetry &symmetry, const SymmetrySet symmetries) {
+
+			PackedBoard canonical = board;
+			symmetry = 0;
+
+			// every transformation is one of two bases mirrored, so transposition is computed once
+			PackedBoard bases[2] = { board, (symmetries & 0xF0) ? Transpose<Size>(board) : board };
+
+			for( Symmetry candidate = 1; candidate < SymmetryCount; candidate++ ) {
+
+				if( !(symmetries & (1 << candidate)) ) continue;
+
+				PackedBoard transformed = bases[candidate >> 2];
+				if( candidate & SYMMETRY_MIRROR_COLUMNS ) transformed = MirrorColumns<Size>(transformed);
+				if( candidate & SYMMETRY_MIRROR_ROWS ) transformed = MirrorRows<Size>(transformed);
+
+				if( transformed < canonical ) {
+					canonical = transformed;
+					symmetry = candidate;
+				}
+
+			}
+
+			return canonical;
+		}
+
+		/// <summary>
+		/// Lowest nibble bits of cells in first rows and columns of board
+		/// </summary>
+		template<int Size>
+		consteval PackedBoard GetCellBits(const int rows, const int cols) {
+
+			PackedBoard bits = 0;
+
+			for( int row = 0; row < rows; row++ ) {
+				for( int col = 0; col < cols; col++ ) {
+					bits |= PackedBoard(1) << (4 * (row * Size + col));
+				}
+			}
+
+			return bits;
+		}
+
+		/// <summary>
+		/// Lowest bit of every nonzero nibble
+		/// </summary>
+		inline PackedBoard GetNonZeroNibbles(const PackedBoard board) {
+			return (board | (board >> 1) | (board >> 2) | (board >> 3)) & NibbleBits;
+		}
+
+		/// <summary>
+		/// Every cell is compared with its right and lower neighbour at once on shifted copies of board,
+		/// there is no branch and no table, so loop over many boards is vectorized by compiler
+		/// </summary>
+		template<int Size>
+		inline uint8_t GetLegalMoves(const PackedBoard board) {
+
+			constexpr PackedBoard cells = GetCellBits<Size>(Size, Size);
+			constexpr PackedBoard rowPairs = GetCellBits<Size>(Size, Size - 1);
+			constexpr PackedBoard columnPairs = GetCellBits<Size>(Size - 1, Size);
+
+			// shifts moving right and lower neighbour to cell
+			constexpr int nextCol = 4;
+			constexpr int nextRow = 4 * Size;
+
+			PackedBoard occupied = GetNonZeroNibbles(board);
+			PackedBoard empty = occupied ^ cells;
+
+			PackedBoard sameRight = occupied & ~GetNonZeroNibbles(board ^ (board >> nextCol));
+			PackedBoard sameBelow = occupied & ~GetNonZeroNibbles(board ^ (board >> nextRow));
+
+			// tile moves to empty neighbour or merges with the same one
+			PackedBoard left = ((empty & (occupied >> nextCol)) | sameRight) & rowPairs;
+			PackedBoard right = ((occupied & (empty >> nextCol)) | sameRight) & rowPairs;
+			PackedBoard up = ((empty & (occupied >> nextRow)) | sameBelow) & columnPairs;
+			PackedBoard down = ((occupied & (empty >> nextRow)) | sameBelow) & columnPairs;
+
+			// every direction gets own bit of nibble, OR of all nibbles is the mask
+			PackedBoard moves = up * MASK_UP | right * MASK_RIGHT | down * MASK_DOWN | left * MASK_LEFT;
+
+			moves |= moves >> 32;
+			moves |= moves >> 16;
+			moves |= moves >> 8;
+			moves |= moves >> 4;
+
+			return moves & 0xF;
+		}
+
+		template<int Size>
+		std::size_t GetLegalMoves(const PackedBoard *boards, const std::size_t count, uint8_t *legalMoves) {
+
+			std::size_t finished = 0;
+
+			for( std::size_t i = 0; i < count; i++ ) {
+
+				legalMoves[i] = GetLegalMoves<Size>(boards[i]);
+				finished += legalMoves[i] == 0;
+
+			}
+
+			return finished;
+		}
+
+		template<int Size>
+		MoveResult Move(PackedBoard &board, const Direction direction) {
+
+			const RowTables<Size> &tables = GetRowTables<Size>();
+			const PackedBoard rowMask = (PackedBoard(1) << (4 * Size)) - 1;
+
+			bool vertical = direction == UP || direction == DOWN;
+			bool low = direction == UP || direction == LEFT;
+
+			// columns are moved as rows of transposed board
+			PackedBoard source = vertical ? Transpose<Size>(board) : board;
+			PackedBoard moved = 0;
+
+			MoveResult result;
+
+			for( int i = 0; i < Size; i++ ) {
+
+				PackedBoard row = (source >> (4 * Size * i)) & rowMask;
+
+				moved |= PackedBoard(low ? tables.MovedLow[row] : tables.MovedHigh[row]) << (4 * Size * i);
+				result.ScoreDelta += tables.Score[row];
+				result.Merges += tables.Merges[row];
+
+			}
+
+			if( vertical ) moved = Transpose<Size>(moved);
+
+			result.Changed = moved != board;
+			result.LegalMoves = GetLegalMoves<Size>(moved);
+
+			board = moved;
+
+			return result;
+		}
+
+	}
+
+	bool IsPackedBoardSize(const int8_t boardSize) {
+		return boardSize == 3 || boardSize == 4;
+	}
+
+	PackedBoard PackBoard(const GameBoard &board) {
+
+		PackedBoard packed = 0;
+		int shift = 0;
+
+		for( const auto &row : board ) {
+			for( uint16_t value : row ) {
+
+				if( value != 0 ) {
+					packed |= PackedBoard(std::countr_zero(value)) << shift;
+				}
+
+				shift += 4;
+
+			}
+		}
+
+		return packed;
+	}
+
+	GameBoard UnpackBoard(const PackedBoard board, const int8_t boardSize) {
+
+		GameBoard unpacked(boardSize, std::pmr::vector<uint16_t>(boardSize));
+		int shift = 0;
+
+		for( auto &row : unpacked ) {
+			for( uint16_t &value : row ) {
+
+				uint8_t exponent = (board >> shift) & 0xF;
+				value = exponent != 0 ? 1 << exponent : 0;
+
+				shift += 4;
+
+			}
+		}
+
+		return unpacked;
+	}
+
+	MoveResult MovePackedBoard(PackedBoard &board, const int8_t boardSize, const Direction direction) {
+		return boardSize == 3 ? Move<3>(board, direction) : Move<4>(board, direction);
+	}
+
+	uint8_t GetPackedLegalMoves(const PackedBoard board, const int8_t boardSize) {
+		return boardSize == 3 ? GetLegalMoves<3>(board) : GetLegalMoves<4>(board);
+	}
+
+	std::size_t GetPackedLegalMoves(const PackedBoard *boards, const std::size_t count, const int8_t boardSize, uint8_t *legalMoves) {
+		return boardSize == 3 ? GetLegalMoves<3>(boards, count, legalMoves) : GetLegalMoves<4>(boards, count, legalMoves);
+	}
+
+	uint32_t GetPackedEmptyCells(const PackedBoard board, const int8_t boardSize) {
+
+		// lowest bit of every nibble is set for empty cell
+		PackedBoard cells = GetNonZeroNibbles(board) ^ NibbleBits;
+
+		// gather nibble bits to consecutive bits
+		cells = (cells | (cells >> 3)) & 0x0303030303030303;
+		cells = (cells | (cells >> 6)) & 0x000F000F000F000F;
+		cells = (cells | (cells >> 12)) & 0x000000FF000000FF;
+		cells = (cells | (cells >> 24)) & 0xFFFF;
+
+		return uint32_t(cells) & ((uint32_t(1) << (boardSize * boardSize)) - 1);
+	}
+
+	PackedBoard SpawnPackedTile(const PackedBoard board, const int8_t boardSize, const SpawnOutcome &outcome) {
+
+		PackedBoard exponent = std::countr_zero(outcome.Value);
+		return board | (exponent << ((outcome.Row * boardSize + outcome.Col) * 4));
+
+	}
+
+	PackedBoard TransformBoard(const PackedBoard board, const int8_t boardSize, const Symmetry symmetry) {
+		return boardSize == 3 ? Transform<3>(board, symmetry) : Transform<4>(board, symmetry);
+	}
+
+	Direction TransformDirection(Direction direction, const Symmetry symmetry) {
+
+		if( symmetry & SYMMETRY_TRANSPOSE ) {
+
+			switch( direction ) {
+				case Direction::UP: direction = LEFT; break;
+				case Direction::LEFT: direction = UP; break;
+				case Direction::DOWN: direction = RIGHT; break;
+				case Direction::RIGHT: direction = DOWN; break;
+				default: break;
+			}
+
+		}
+
+		if( symmetry & SYMMETRY_MIRROR_COLUMNS ) {
+			if( direction == LEFT ) direction = RIGHT;
+			else if( direction == RIGHT ) direction = LEFT;
+		}
+
+		if( symmetry & SYMMETRY_MIRROR_ROWS ) {
+			if( direction == UP ) direction = DOWN;
+			else if( direction == DOWN ) direction = UP;
+		}
+
+		return direction;
+	}
+
+	Symmetry InverseSymmetry(const Symmetry symmetry) {
+
+		if( !(symmetry & SYMMETRY_TRANSPOSE) ) return symmetry;
+
+		// undoing mirrors after transposition mirrors the other axis
+		Symmetry mirrors = 0;
+		if( symmetry & SYMMETRY_MIRROR_COLUMNS ) mirrors |= SYMMETRY_MIRROR_ROWS;
+		if( symmetry & SYMMETRY_MIRROR_ROWS ) mirrors |= SYMMETRY_MIRROR_COLUMNS;
+
+		return SYMMETRY_TRANSPOSE | mirrors;
+	}
+
+	PackedBoard CanonicalizeBoard(const PackedBoard board, const int8_t boardSize, Symmetry &symmetry, const SymmetrySet symmetries) {
+		return boardSize == 3 ? Canonicalize<3>(board, symmetry, symmetries) : Canonicalize<4>(board, symmetry, symmetries);
+	}
+
+}
@@ -0,0 +1,139 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Game.h"
+
+namespace Game2048 {
+
+	/// <summary>
+	/// Board stored in 64 bits, every tile is 4-bit exponent (0 - empty, 1 - 2, ..., 15 - 32768),
+	/// rows follow each other from lowest bits, first column of row is in its lowest bits.
+	/// Only boards up to 4x4 fit.
+	/// </summary>
+	using PackedBoard = uint64_t;
+
+	/// <summary>
+	/// One of 8 rotations and reflections of board, bits are applied in order:
+	/// SYMMETRY_TRANSPOSE first, then SYMMETRY_MIRROR_COLUMNS and SYMMETRY_MIRROR_ROWS
+	/// </summary>
+	using Symmetry = uint8_t;
+
+	const Symmetry SYMMETRY_MIRROR_COLUMNS = 1 << 0; // left <-> right
+	const Symmetry SYMMETRY_MIRROR_ROWS = 1 << 1; // up <-> down
+	const Symmetry SYMMETRY_TRANSPOSE = 1 << 2; // swap rows with columns
+
+	const Symmetry SymmetryCount = 8;
+
+	/// <summary>
+	/// Set of symmetries, bit i stands for Symmetry i
+	/// </summary>
+	using SymmetrySet = uint8_t;
+
+	// All rotations and reflections, positions have the same shape
+	const SymmetrySet DihedralSymmetries = 0xFF;
+
+	// Symmetries which keep results of Game::MoveBoard. Mirrors would reverse order in which
+	// merges pair tiles (always from first tile of row or column), only transposition keeps it.
+	const SymmetrySet ExactSymmetries = (1 << 0) | (1 << SYMMETRY_TRANSPOSE);
+
+	/// <summary>
+	/// Can board of given size be packed
+	/// </summary>
+	/// <param name="boardSize"></param>
+	/// <returns></returns>
+	bool IsPackedBoardSize(const int8_t boardSize);
+
+	/// <summary>
+	/// Packs board of Game, tiles have to be powers of two
+	/// </summary>
+	/// <param name="board"></param>
+	/// <returns></returns>
+	PackedBoard PackBoard(const GameBoard &board);
+
+	/// <summary>
+	/// Unpacks board to layout used by Game
+	/// </summary>
+	/// <param name="board"></param>
+	/// <param name="boardSize"></param>
+	/// <returns></returns>
+	GameBoard UnpackBoard(const PackedBoard board, const int8_t boardSize);
+
+	/// <summary>
+	/// Moves packed board with the same rules as Game::MoveBoard, using precomputed row tables
+	/// </summary>
+	/// <param name="board">board which is moved in place</param>
+	/// <param name="boardSize"></param>
+	/// <param name="direction"></param>
+	/// <returns></returns>
+	MoveResult MovePackedBoard(PackedBoard &board, const int8_t boardSize, const Direction direction);
+
+	/// <summary>
+	/// Legal-move mask of packed board, all cells are compared with their neighbours at once
+	/// </summary>
+	/// <param name="board"></param>
+	/// <param name="boardSize"></param>
+	/// <returns>MoveMask bits</returns>
+	uint8_t GetPackedLegalMoves(const PackedBoard board, const int8_t boardSize);
+
+	/// <summary>
+	/// Legal-move masks of many boards of the same size, loop has no branches and is vectorized
+	/// </summary>
+	/// <param name="boards"></param>
+	/// <param name="count"></param>
+	/// <param name="boardSize"></param>
+	/// <param name="legalMoves">receives MoveMask bits of every board, 0 means game over</param>
+	/// <returns>number of boards without legal move</returns>
+	std::size_t GetPackedLegalMoves(const PackedBoard *boards, const std::size_t count, const int8_t boardSize, uint8_t *legalMoves);
+
+	/// <summary>
+	/// Empty cells of packed board for ListSpawnOutcomes
+	/// </summary>
+	/// <returns>bit row * boardSize + col is set for every empty cell</returns>
+	uint32_t GetPackedEmptyCells(const PackedBoard board, const int8_t boardSize);
+
+	/// <summary>
+	/// Puts tile of spawn outcome to empty cell of packed board
+	/// </summary>
+	PackedBoard SpawnPackedTile(const PackedBoard board, const int8_t boardSize, const SpawnOutcome &outcome);
+
+	/// <summary>
+	/// Rotates or reflects packed board
+	/// </summary>
+	/// <param name="board"></param>
+	/// <param name="boardSize"></param>
+	/// <param name="symmetry"></param>
+	/// <returns></returns>
+	PackedBoard TransformBoard(const PackedBoard board, const int8_t boardSize, const Symmetry symmetry);
+
+	/// <summary>
+	/// Direction on transformed board which matches given direction on original board
+	/// </summary>
+	/// <param name="direction"></param>
+	/// <param name="symmetry"></param>
+	/// <returns></returns>
+	Direction TransformDirection(const Direction direction, const Symmetry symmetry);
+
+	/// <summary>
+	/// Symmetry which undoes given one
+	/// </summary>
+	/// <param name="symmetry"></param>
+	/// <returns></returns>
+	Symmetry InverseSymmetry(const Symmetry symmetry);
+
+	/// <summary>
+	/// Maps board to smallest of its transformations, equivalent positions get the same key.
+	/// Move chosen on canonical board is played on original board as
+	/// TransformDirection(move, InverseSymmetry(symmetry)).
+	/// </summary>
+	/// <param name="board"></param>
+	/// <param name="boardSize"></param>
+	/// <param name="symmetry">returns symmetry which transforms board to canonical one</param>
+	/// <param name="symmetries">transformations to consider, ExactSymmetries keep move results</param>
+	/// <returns>canonical board</returns>
+	PackedBoard CanonicalizeBoard(const PackedBoard board, const int8_t boardSize, Symmetry &symmetry, const SymmetrySet symmetries = ExactSymmetries);
+
+}
@@ -0,0 +1,322 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "Perft.h"
+#include "Arena.h"
+#include "PackedBoard.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace Game2048 {
+
+	namespace {
+
+		// probe limit of one insert, reached only by nearly full set
+		const int MaxProbes = 1024;
+
+		/// <summary>
+		/// Reference move generator of Game, positions are copied into arena of calling thread
+		/// </summary>
+		struct GameEngine {
+
+			using Position = Game;
+
+			int8_t BoardSize;
+
+			Position Start(const GameBoard &board) const {
+
+				Game game(BoardSize, 0);
+				game.SetBoard(board, 0);
+
+				return game;
+			}
+
+			uint64_t GetKey(const Game &game) const {
+				return BoardSize <= 4 ? PackBoard(game.GetBoard()) : game.GetHash();
+			}
+
+			template<typename Visit>
+			void ForEachChild(const Game &game, Visit &&visit) const {
+
+				Arena &arena = GetThreadArena();
+
+				for( Direction direction : Directions ) {
+
+					if( !(game.GetLegalMoves() & DirectionMask(direction)) ) continue;
+
+					ArenaScope scope(arena);
+
+					Game moved(game, &arena);
+					moved.MoveBoard(direction);
+
+					SpawnOutcomes outcomes;
+					std::size_t count = moved.GetSpawnOutcomes(outcomes);
+
+					// spawned tile is removed again, no copy per spawn
+					for( std::size_t i = 0; i < count; i++ ) {
+
+						moved.AddTile(outcomes[i].Row, outcomes[i].Col, outcomes[i].Value);
+						visit(static_cast<const Game &>(moved));
+						moved.AddTile(outcomes[i].Row, outcomes[i].Col, 0);
+
+					}
+
+				}
+
+			}
+
+		};
+
+		/// <summary>
+		/// Move generator of packed boards
+		/// </summary>
+		struct PackedEngine {
+
+			using Position = PackedBoard;
+
+			int8_t BoardSize;
+
+			Position Start(const GameBoard &board) const {
+				return PackBoard(board);
+			}
+
+			uint64_t GetKey(const PackedBoard board) const {
+				return board;
+			}
+
+			template<typename Visit>
+			void ForEachChild(const PackedBoard board, Visit &&visit) const {
+
+				uint8_t legalMoves = GetPackedLegalMoves(board, BoardSize);
+
+				for( Direction direction : Directions ) {
+
+					if( !(legalMoves & DirectionMask(direction)) ) continue;
+
+					PackedBoard moved = board;
+					MovePackedBoard(moved, BoardSize, direction);
+
+					// perft counts paths only, probabilities of spawn outcomes are not needed
+					for( int cell = 0; cell < BoardSize * BoardSize; cell++ ) {
+
+						if( (moved >> (cell * 4)) & 0xF ) continue;
+
+						// exponents 1 and 2 are tiles 2 and 4
+						visit(moved | (PackedBoard(1) << (cell * 4)));
+						visit(moved | (PackedBoard(2) << (cell * 4)));
+
+					}
+
+				}
+
+			}
+
+		};
+
+		template<typename Engine>
+		void CountPaths(const Engine &engine, const typename Engine::Position &position, const int depth, const int maxDepth, uint64_t *nodes) {
+
+			nodes[depth]++;
+
+			if( depth == maxDepth ) return;
+
+			engine.ForEachChild(position, [&](const typename Engine::Position &child) {
+				CountPaths(engine, child, depth + 1, maxDepth, nodes);
+			});
+
+		}
+
+		/// <summary>
+		/// Runs work(thread, index) for every index below count, indices are claimed in chunks
+		/// </summary>
+		template<typename Work>
+		void ParallelFor(const unsigned threadCount, const uint64_t count, Work &&work) {
+
+			std::atomic<uint64_t> next = 0;
+			std::vector<std::thread> threads;
+
+			for( unsigned t = 0; t < threadCount; t++ ) {
+
+				threads.emplace_back([&, t]() {
+
+					const uint64_t chunk = 64;
+
+					uint64_t first;
+					while( (first = next.fetch_add(chunk)) < count ) {
+						for( uint64_t i = first; i < std::min(first + chunk, count); i++ ) {
+							work(t, i);
+						}
+					}
+
+				});
+
+			}
+
+			for( std::thread &thread : threads ) {
+				thread.join();
+			}
+
+		}
+
+		template<typename Engine>
+		void Perft(const Engine &engine, const PerftConfig &config, PerftReport &report) {
+
+			using Position = typename Engine::Position;
+
+			unsigned threadCount = std::max(1u, config.Threads);
+
+			std::vector<Position> frontier { engine.Start(config.Board) };
+			report.Nodes.assign(config.Depth + 1, 0);
+			report.Nodes[0] = 1;
+
+			if( config.Deduplicate ) {
+
+				ConcurrentKeySet keys(config.HashBits);
+
+				// level by level, set holds only one depth at a time
+				for( int depth = 1; depth <= config.Depth && !frontier.empty(); depth++ ) {
+
+					std::vector<std::vector<Position>> next(threadCount);
+					std::vector<uint64_t> generated(threadCount, 0);
+
+					ParallelFor(threadCount, frontier.size(), [&](const unsigned thread, const uint64_t i) {
+
+						engine.ForEachChild(frontier[i], [&](const Position &child) {
+
+							generated[thread]++;
+
+							if( keys.Insert(engine.GetKey(child)) ) {
+								next[thread].push_back(Position(child));
+							}
+
+						});
+
+					});
+
+					frontier.clear();
+
+					for( unsigned t = 0; t < threadCount; t++ ) {
+
+						report.Generated += generated[t];
+						std::move(next[t].begin(), next[t].end(), std::back_inserter(frontier));
+
+					}
+
+					report.Nodes[depth] = frontier.size();
+
+					if( keys.IsFull() ) report.Complete = false;
+					keys.Clear();
+
+				}
+
+				return;
+			}
+
+			// expand first levels serially until every thread has enough subtrees
+			int splitDepth = 0;
+
+			while( splitDepth < config.Depth && frontier.size() < threadCount * 64 ) {
+
+				std::vector<Position> next;
+
+				for( const Position &position : frontier ) {
+					engine.ForEachChild(position, [&](const Position &child) {
+						next.push_back(Position(child));
+					});
+				}
+
+				frontier = std::move(next);
+				splitDepth++;
+
+				report.Nodes[splitDepth] = frontier.size();
+				report.Generated += frontier.size();
+
+			}
+
+			// every thread counts into its own row
+			std::vector<std::vector<uint64_t>> nodes(threadCount, std::vector<uint64_t>(config.Depth + 1, 0));
+
+			ParallelFor(threadCount, frontier.size(), [&](const unsigned thread, const uint64_t i) {
+				CountPaths(engine, frontier[i], splitDepth, config.Depth, nodes[thread].data());
+			});
+
+			for( unsigned t = 0; t < threadCount; t++ ) {
+				for( int depth = splitDepth + 1; depth <= config.Depth; depth++ ) {
+
+					report.Nodes[depth] += nodes[t][depth];
+					report.Generated += nodes[t][depth];
+
+				}
+			}
+
+		}
+
+	}
+
+	ConcurrentKeySet::ConcurrentKeySet(const int bits) : Slots(std::size_t(1) << bits), Shift(64 - bits) {}
+
+	bool ConcurrentKeySet::Insert(const uint64_t key) {
+
+		if( key == 0 ) return !HasZero.exchange(true);
+
+		uint64_t mask = Slots.size() - 1;
+		uint64_t index = (key * 0x9E3779B97F4A7C15ull) >> Shift;
+
+		for( int probe = 0; probe < MaxProbes; probe++ ) {
+
+			std::atomic<uint64_t> &slot = Slots[(index + probe) & mask];
+
+			uint64_t stored = slot.load(std::memory_order_relaxed);
+
+			if( stored == 0 ) {
+
+				// another thread may take the slot first, its key is checked below
+				if( slot.compare_exchange_strong(stored, key, std::memory_order_relaxed) ) return true;
+
+			}
+
+			if( stored == key ) return false;
+
+		}
+
+		// key could not be stored, it is counted as new
+		Full = true;
+
+		return true;
+	}
+
+	void ConcurrentKeySet::Clear() {
+
+		for( std::atomic<uint64_t> &slot : Slots ) {
+			slot.store(0, std::memory_order_relaxed);
+		}
+
+		HasZero = false;
+		Full = false;
+
+	}
+
+	bool ConcurrentKeySet::IsFull() const {
+		return Full;
+	}
+
+	PerftReport RunPerft(const PerftConfig &config) {
+
+		auto start = std::chrono::steady_clock::now();
+
+		PerftReport report;
+		int8_t boardSize = config.Board.size();
+
+		if( config.Packed && IsPackedBoardSize(boardSize) ) {
+			Perft(PackedEngine { boardSize }, config, report);
+		} else {
+			Perft(GameEngine { boardSize }, config, report);
+		}
+
+		report.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return report;
+	}
+
+}
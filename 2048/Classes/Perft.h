@@ -0,0 +1,95 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "Game.h"
+
+namespace Game2048 {
+
+	/// <summary>
+	/// Insert-only set of 64-bit keys shared by threads, open addressing without locks
+	/// </summary>
+	class ConcurrentKeySet {
+
+	public:
+
+		ConcurrentKeySet(const int bits);
+
+		/// <summary>
+		/// Adds key to set
+		/// </summary>
+		/// <param name="key"></param>
+		/// <returns>true if key was not in set before</returns>
+		bool Insert(const uint64_t key);
+
+		/// <summary>
+		/// Removes all keys, may not run concurrently with Insert
+		/// </summary>
+		void Clear();
+
+		/// <summary>
+		/// Set run out of free slots, some inserted keys were not stored
+		/// </summary>
+		bool IsFull() const;
+
+	private:
+
+		// 0 marks free slot, key 0 has its own flag
+		std::vector<std::atomic<uint64_t>> Slots;
+		std::atomic<bool> HasZero = false;
+
+		int Shift;
+		std::atomic<bool> Full = false;
+
+	};
+
+	struct PerftConfig {
+
+		// Position to enumerate from, its size is board size
+		GameBoard Board;
+
+		// Player moves, every one followed by all spawns
+		int Depth = 3;
+
+		unsigned Threads = 1;
+
+		// Count every position once per depth and expand it only once
+		bool Deduplicate = false;
+
+		// Deduplication set has 2^HashBits slots
+		int HashBits = 24;
+
+		// Generate moves by packed row tables instead of Game::MoveBoard, only boards 3x3 and 4x4
+		bool Packed = false;
+
+	};
+
+	struct PerftReport {
+
+		// Positions after every number of moves, index 0 is given board
+		std::vector<uint64_t> Nodes;
+
+		// Generated positions including duplicates
+		uint64_t Generated = 0;
+
+		double Seconds = 0;
+
+		// False when deduplication set was full and counts are not exact
+		bool Complete = true;
+
+	};
+
+	/// <summary>
+	/// Enumerates positions reachable from board: every legal move followed by spawn of 2 and 4
+	/// on every empty tile. Without deduplication it counts paths like chess perft, with it
+	/// distinct positions, keys of 5x5 boards are Zobrist hashes so rare collisions are possible.
+	/// </summary>
+	/// <param name="config"></param>
+	/// <returns></returns>
+	PerftReport RunPerft(const PerftConfig &config);
+
+}
@@ -0,0 +1,191 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "Policy.h"
+
+#include <bit>
+#include <limits>
+
+namespace Game2048 {
+
+	RandomPolicy::RandomPolicy(const uint64_t seed) {
+
+		std::seed_seq sequence { static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) };
+		Random.seed(sequence);
+
+	}
+
+	Direction RandomPolicy::ChooseMove(const Game &game) {
+
+		uint8_t legalMoves = game.GetLegalMoves();
+
+		// pick n-th set bit of legal-move mask
+		int choice = Random() % std::popcount(legalMoves);
+
+		for( Direction direction : Directions ) {
+
+			if( !(legalMoves & DirectionMask(direction)) ) continue;
+			if( choice-- == 0 ) return direction;
+
+		}
+
+		return UP;
+	}
+
+	Direction GreedyPolicy::ChooseMove(const Game &game) {
+
+		Direction bestDirection = UP;
+		int64_t bestScore = -1;
+
+		for( Direction direction : Directions ) {
+
+			if( !(game.GetLegalMoves() & DirectionMask(direction)) ) continue;
+
+			Game nextGame = game;
+			MoveResult result = nextGame.MoveBoard(direction);
+
+			if( result.ScoreDelta > bestScore ) {
+				bestScore = result.ScoreDelta;
+				bestDirection = direction;
+			}
+
+		}
+
+		return bestDirection;
+	}
+
+	ExpectimaxPolicy::ExpectimaxPolicy(const SearchConfig &config) : Search(GetDefaultEvaluator(), config) {}
+
+	Direction ExpectimaxPolicy::ChooseMove(const Game &game) {
+		return Search.Search(game).Move;
+	}
+
+	MonteCarloPolicy::MonteCarloPolicy(const uint64_t seed, const int rollouts, const int rolloutDepth)
+		: Rollouts(rollouts), RolloutDepth(rolloutDepth) {
+
+		std::seed_seq sequence { static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32) };
+		Random.seed(sequence);
+
+	}
+
+	Direction MonteCarloPolicy::ChooseMove(const Game &game) {
+
+		Direction bestDirection = UP;
+		double bestScore = -1;
+
+		for( Direction direction : Directions ) {
+
+			if( !(game.GetLegalMoves() & DirectionMask(direction)) ) continue;
+
+			uint64_t total = 0;
+
+			for( int rollout = 0; rollout < Rollouts; rollout++ ) {
+
+				// copy would repeat spawns of played game, every playout gets its own
+				Game playout = game;
+				playout.Seed(Random());
+
+				total += playout.MoveBoard(direction).ScoreDelta;
+				playout.AddRandomTile();
+
+				for( int depth = 0; depth < RolloutDepth && playout.GetLegalMoves() != 0; depth++ ) {
+
+					uint8_t legalMoves = playout.GetLegalMoves();
+					int choice = Random() % std::popcount(legalMoves);
+
+					for( Direction move : Directions ) {
+
+						if( !(legalMoves & DirectionMask(move)) || choice-- != 0 ) continue;
+
+						total += playout.MoveBoard(move).ScoreDelta;
+						playout.AddRandomTile();
+
+						break;
+					}
+
+				}
+
+			}
+
+			double score = static_cast<double>(total) / Rollouts;
+
+			if( score > bestScore ) {
+				bestScore = score;
+				bestDirection = direction;
+			}
+
+		}
+
+		return bestDirection;
+	}
+
+	HeuristicPolicy::HeuristicPolicy(const Evaluator &evaluator) : ValueFunction(evaluator) {}
+
+	Direction HeuristicPolicy::ChooseMove(const Game &game) {
+
+		Direction bestDirection = UP;
+		double bestValue = -std::numeric_limits<double>::infinity();
+
+		for( Direction direction : Directions ) {
+
+			if( !(game.GetLegalMoves() & DirectionMask(direction)) ) continue;
+
+			// value of afterstate, before tile is spawned
+			Game afterstate = game;
+			afterstate.MoveBoard(direction);
+
+			double value = ValueFunction.Evaluate(afterstate);
+
+			if( value > bestValue ) {
+				bestValue = value;
+				bestDirection = direction;
+			}
+
+		}
+
+		return bestDirection;
+	}
+
+	std::unique_ptr<Policy> CreatePolicy(const std::string &name, const uint64_t seed) {
+
+		std::size_t colon = name.find(':');
+		std::string baseName = name.substr(0, colon);
+
+		int parameter = 0;
+
+		if( colon != std::string::npos ) {
+
+			std::string value = name.substr(colon + 1);
+
+			if( value.empty() || value.find_first_not_of("0123456789") != std::string::npos ) return nullptr;
+
+			parameter = std::stoi(value);
+			if( parameter <= 0 ) return nullptr;
+
+		}
+
+		if( baseName == "random" && colon == std::string::npos ) return std::make_unique<RandomPolicy>(seed);
+		if( baseName == "greedy" && colon == std::string::npos ) return std::make_unique<GreedyPolicy>();
+		if( baseName == "heuristic" && colon == std::string::npos ) return std::make_unique<HeuristicPolicy>(GetDefaultEvaluator());
+
+		if( baseName == "montecarlo" ) return std::make_unique<MonteCarloPolicy>(seed, parameter > 0 ? parameter : 100);
+
+		if( baseName == "expectimax" ) {
+
+			SearchConfig config;
+			config.UseCache = true;
+
+			// fixed depth makes games reproducible, time of machine does not matter
+			if( parameter > 0 ) {
+				config.MaxDepth = parameter;
+				config.TimeBudget = std::chrono::hours(24);
+			} else {
+				config.UseOpeningBook = true;
+			}
+
+			return std::make_unique<ExpectimaxPolicy>(config);
+		}
+
+		return nullptr;
+	}
+
+}
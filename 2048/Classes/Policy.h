@@ -0,0 +1,146 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Game.h"
+#include "Search.h"
+
+namespace Game2048 {
+
+	/// <summary>
+	/// Decides moves of automatically played games
+	/// </summary>
+	class Policy {
+
+	public:
+
+		virtual ~Policy() = default;
+
+		/// <summary>
+		/// Choose direction of next move, game has to have at least one legal move
+		/// </summary>
+		/// <param name="game"></param>
+		/// <returns></returns>
+		virtual Direction ChooseMove(const Game &game) = 0;
+
+	};
+
+	/// <summary>
+	/// Plays uniformly random legal move
+	/// </summary>
+	class RandomPolicy : public Policy {
+
+	public:
+
+		RandomPolicy(const uint64_t seed);
+
+		Direction ChooseMove(const Game &game) override;
+
+	private:
+
+		std::minstd_rand Random;
+
+	};
+
+	/// <summary>
+	/// Plays legal move with biggest immediate score gain
+	/// </summary>
+	class GreedyPolicy : public Policy {
+
+	public:
+
+		Direction ChooseMove(const Game &game) override;
+
+	};
+
+	/// <summary>
+	/// Plays best move of time-budgeted expectimax search with default evaluator
+	/// </summary>
+	class ExpectimaxPolicy : public Policy {
+
+	public:
+
+		ExpectimaxPolicy(const SearchConfig &config);
+
+		Direction ChooseMove(const Game &game) override;
+
+	private:
+
+		ExpectimaxSearch Search;
+
+	};
+
+	/// <summary>
+	/// Plays move with best average score of random playouts started by it
+	/// </summary>
+	class MonteCarloPolicy : public Policy {
+
+	public:
+
+		MonteCarloPolicy(const uint64_t seed, const int rollouts = 100, const int rolloutDepth = 20);
+
+		Direction ChooseMove(const Game &game) override;
+
+	private:
+
+		std::minstd_rand Random;
+
+		// Playouts of every legal move
+		int Rollouts;
+
+		// Random moves of one playout after chosen move
+		int RolloutDepth;
+
+	};
+
+	/// <summary>
+	/// Plays move leading to afterstate with best value of evaluator, one ply greedy counterpart of expectimax
+	/// </summary>
+	class HeuristicPolicy : public Policy {
+
+	public:
+
+		HeuristicPolicy(const Evaluator &evaluator);
+
+		Direction ChooseMove(const Game &game) override;
+
+	private:
+
+		const Evaluator &ValueFunction;
+
+	};
+
+	/// <summary>
+	/// Names accept parameter after colon: "montecarlo:200" sets rollouts per move,
+	/// "expectimax:3" searches exactly to given depth without time limit
+	/// </summary>
+	const std::vector<std::string> PolicyNames {
+		"random",
+		"greedy",
+		"montecarlo",
+		"expectimax",
+		"heuristic"
+	};
+
+	/// <summary>
+	/// Creates policy by its name from PolicyNames
+	/// </summary>
+	/// <param name="name">name with optional ":parameter"</param>
+	/// <param name="seed">seed of policies making random decisions</param>
+	/// <returns>nullptr for unknown name or invalid parameter</returns>
+	std::unique_ptr<Policy> CreatePolicy(const std::string &name, const uint64_t seed);
+
+	/// <summary>
+	/// Seed of policy playing game with given seed, policy generator would repeat tile spawns of game otherwise
+	/// </summary>
+	constexpr uint64_t GetPolicySeed(const uint64_t gameSeed) {
+		return gameSeed ^ 0x9E3779B97F4A7C15ull;
+	}
+
+}
@@ -0,0 +1,159 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "PositionCodec.h"
+#include "Game.h"
+
+#include <bit>
+
+namespace Game2048 {
+
+	namespace {
+
+		const char ExponentDigits[] = "0123456789abcdef";
+
+		uint8_t GetTileExponent(const uint16_t value) {
+			return value == 0 ? 0 : std::countr_zero(value);
+		}
+
+		uint16_t GetTileValue(const uint8_t exponent) {
+			return exponent == 0 ? 0 : uint16_t(1) << exponent;
+		}
+
+		/// <summary>
+		/// Value of hexadecimal digit or -1
+		/// </summary>
+		int ParseExponent(const char digit) {
+
+			if( digit >= '0' && digit <= '9' ) return digit - '0';
+			if( digit >= 'a' && digit <= 'f' ) return digit - 'a' + 10;
+			if( digit >= 'A' && digit <= 'F' ) return digit - 'A' + 10;
+
+			return -1;
+		}
+
+		GameBoard CreateBoard(const int8_t boardSize) {
+			return GameBoard(boardSize, std::pmr::vector<uint16_t>(boardSize));
+		}
+
+	}
+
+	std::string EncodePosition(const GameBoard &board, const uint32_t score) {
+
+		std::string position = std::to_string(board.size()) + ":";
+
+		for( std::size_t row = 0; row < board.size(); row++ ) {
+
+			if( row > 0 ) position += '/';
+
+			for( uint16_t tile : board[row] ) {
+				position += ExponentDigits[GetTileExponent(tile) & 0xF];
+			}
+
+		}
+
+		return position + ":" + std::to_string(score);
+	}
+
+	bool DecodePosition(const std::string &position, GameBoard &board, uint32_t &score) {
+
+		std::size_t sizeEnd = position.find(':');
+		if( sizeEnd != 1 ) return false;
+
+		int8_t boardSize = position[0] - '0';
+		if( boardSize < MinBoardSize || boardSize > MaxBoardSize ) return false;
+
+		std::size_t rowsEnd = position.find(':', sizeEnd + 1);
+		std::string rows = position.substr(sizeEnd + 1, rowsEnd == std::string::npos ? std::string::npos : rowsEnd - sizeEnd - 1);
+
+		// every row has size digits and separator except last one
+		if( rows.size() != (std::size_t) boardSize * (boardSize + 1) - 1 ) return false;
+
+		GameBoard decoded = CreateBoard(boardSize);
+
+		for( int8_t row = 0; row < boardSize; row++ ) {
+
+			std::size_t rowStart = row * (boardSize + 1);
+			if( row > 0 && rows[rowStart - 1] != '/' ) return false;
+
+			for( int8_t col = 0; col < boardSize; col++ ) {
+
+				int exponent = ParseExponent(rows[rowStart + col]);
+				if( exponent < 0 ) return false;
+
+				decoded[row][col] = GetTileValue(exponent);
+
+			}
+
+		}
+
+		uint32_t decodedScore = 0;
+
+		if( rowsEnd != std::string::npos ) {
+
+			std::string scoreText = position.substr(rowsEnd + 1);
+			if( scoreText.empty() || scoreText.size() > 10 || scoreText.find_first_not_of("0123456789") != std::string::npos ) return false;
+
+			uint64_t value = std::stoull(scoreText);
+			if( value > UINT32_MAX ) return false;
+
+			decodedScore = value;
+
+		}
+
+		board = std::move(decoded);
+		score = decodedScore;
+
+		return true;
+	}
+
+	std::vector<uint8_t> EncodePositionBinary(const GameBoard &board, const uint32_t score) {
+
+		std::size_t cells = board.size() * board.size();
+
+		std::vector<uint8_t> position(5 + (cells + 1) / 2, 0);
+		position[0] = board.size();
+
+		for( int i = 0; i < 4; i++ ) {
+			position[1 + i] = score >> (i * 8);
+		}
+
+		for( std::size_t cell = 0; cell < cells; cell++ ) {
+
+			uint8_t exponent = GetTileExponent(board[cell / board.size()][cell % board.size()]) & 0xF;
+			position[5 + cell / 2] |= cell % 2 == 0 ? exponent : exponent << 4;
+
+		}
+
+		return position;
+	}
+
+	bool DecodePositionBinary(const std::vector<uint8_t> &position, GameBoard &board, uint32_t &score) {
+
+		if( position.empty() ) return false;
+
+		int8_t boardSize = position[0];
+		if( boardSize < MinBoardSize || boardSize > MaxBoardSize ) return false;
+
+		std::size_t cells = boardSize * boardSize;
+		if( position.size() != 5 + (cells + 1) / 2 ) return false;
+
+		GameBoard decoded = CreateBoard(boardSize);
+
+		for( std::size_t cell = 0; cell < cells; cell++ ) {
+
+			uint8_t byte = position[5 + cell / 2];
+			decoded[cell / boardSize][cell % boardSize] = GetTileValue(cell % 2 == 0 ? byte & 0xF : byte >> 4);
+
+		}
+
+		score = 0;
+		for( int i = 0; i < 4; i++ ) {
+			score |= uint32_t(position[1 + i]) << (i * 8);
+		}
+
+		board = std::move(decoded);
+
+		return true;
+	}
+
+}
@@ -0,0 +1,45 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <memory_resource>
+
+namespace Game2048 {
+
+	using GameBoard = std::pmr::vector<std::pmr::vector<uint16_t>>;
+
+	/// <summary>
+	/// Encodes position as text "size:rows:score", rows are separated by '/' and every tile is
+	/// hexadecimal exponent (0 empty, 1 = 2, b = 2048), e.g. "4:1000/0000/0020/000b:20480"
+	/// </summary>
+	/// <param name="board">square board of powers of two up to 32768</param>
+	/// <param name="score"></param>
+	/// <returns></returns>
+	std::string EncodePosition(const GameBoard &board, const uint32_t score);
+
+	/// <summary>
+	/// Decodes text position, score part may be left out
+	/// </summary>
+	/// <param name="position"></param>
+	/// <param name="board">decoded board</param>
+	/// <param name="score">decoded score, 0 if missing</param>
+	/// <returns>false for malformed position or unsupported board size</returns>
+	bool DecodePosition(const std::string &position, GameBoard &board, uint32_t &score);
+
+	/// <summary>
+	/// Encodes position as bytes: size, score (4 bytes little endian), exponents two per byte
+	/// with first tile in low nibble. Board 4x4 takes 13 bytes.
+	/// </summary>
+	std::vector<uint8_t> EncodePositionBinary(const GameBoard &board, const uint32_t score);
+
+	/// <summary>
+	/// Decodes binary position
+	/// </summary>
+	/// <returns>false for malformed position or unsupported board size</returns>
+	bool DecodePositionBinary(const std::vector<uint8_t> &position, GameBoard &board, uint32_t &score);
+
+}
@@ -0,0 +1,568 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "Renderer.h"
+#include "UI.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+namespace Game2048 {
+
+	namespace {
+
+		// row of seed in side window, right under high scores
+		const int SeedRow = 13;
+
+		// first row of post-game analysis in side window
+		const int AnalysisRow = 15;
+
+		std::size_t GetShownCount(const std::vector<ScoreRecord> *highScores, const std::size_t count) {
+			return highScores ? std::min(count, highScores->size()) : 0;
+		}
+
+		/// <summary>
+		/// Line of high score screen with score, max tile, moves and date
+		/// </summary>
+		std::string FormatRecord(const std::size_t position, const ScoreRecord &record) {
+
+			time_t time = record.Timestamp;
+			tm local {};
+			localtime_r(&time, &local);
+
+			char date[16];
+			strftime(date, sizeof(date), "%Y-%m-%d", &local);
+
+			char line[96];
+			snprintf(line, sizeof(line), "%2d.) %7u  %5u  %5u moves  %s", static_cast<int>(position), record.Score, record.MaxTile,
+				record.Moves, date);
+
+			return line;
+		}
+
+		std::size_t Utf8Length(const std::string &text) {
+			return std::count_if(text.begin(), text.end(), [](const char c) { return (c & 0xC0) != 0x80; });
+		}
+
+		std::string Format(const char *format, const int value) {
+
+			char text[32];
+			snprintf(text, sizeof(text), format, value);
+
+			return text;
+		}
+
+	}
+
+	GameLayout GetGameLayout(const int rows, const int cols, const int8_t boardSize) {
+
+		// last two rows belong to guide and copyright
+		int rowCenter = (rows - 2) / 2;
+		int colCenter = cols / 2;
+
+		GameLayout layout;
+
+		layout.Board.Height = TileHeight * (boardSize + 1);
+		layout.Board.Width = TileWidth * boardSize + 6;
+		layout.Board.Row = rowCenter - layout.Board.Height / 2;
+		layout.Board.Col = colCenter - boardSize * 10 / 2 - 15;
+
+		layout.HighScore.Height = layout.Board.Height;
+		layout.HighScore.Width = 22;
+		layout.HighScore.Row = layout.Board.Row;
+		layout.HighScore.Col = layout.Board.Col + layout.Board.Width + 5;
+
+		return layout;
+	}
+
+	WindowRect GetHighScoreLayout(const int rows, const int cols) {
+
+		int rowCenter = (rows - 2) / 2;
+		int colCenter = cols / 2;
+
+		WindowRect rect;
+		rect.Height = rowCenter + rowCenter / 2;
+		rect.Width = colCenter + colCenter / 2;
+		rect.Row = rowCenter - rect.Height / 2;
+		rect.Col = colCenter - rect.Width / 2;
+
+		return rect;
+	}
+
+	void Renderer::Resize(const int rows, const int cols) {
+
+		Rows = rows;
+		Cols = cols;
+		LayoutPending = true;
+
+	}
+
+	void Renderer::DrawGame(const GameFrame &frame) {
+		Draw(SCREEN_GAME, [&]() { RenderGame(frame); });
+	}
+
+	void Renderer::DrawHighScore(const HighScoreFrame &frame) {
+		Draw(SCREEN_HIGH_SCORE, [&]() { RenderHighScore(frame); });
+	}
+
+	const RenderStatistics &Renderer::GetStatistics() const {
+		return Statistics;
+	}
+
+	void Renderer::Draw(const Screen screen, const std::function<void()> &render) {
+
+		if( screen != LastScreen ) {
+			LayoutPending = true;
+			LastScreen = screen;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		render();
+
+		Statistics.Nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		Statistics.Frames++;
+
+		LayoutPending = false;
+
+	}
+
+	NcursesRenderer::~NcursesRenderer() {
+		DeleteWindows();
+	}
+
+	void NcursesRenderer::DeleteWindows() {
+
+		if( MainWindow ) delwin(MainWindow);
+		if( SideWindow ) delwin(SideWindow);
+
+		MainWindow = nullptr;
+		SideWindow = nullptr;
+
+	}
+
+	void NcursesRenderer::RenderGame(const GameFrame &frame) {
+
+		const Game &game = *frame.CurrentGame;
+
+		// game over label is on stdscr, hiding it needs whole screen
+		if( LayoutPending || (GameOverShown && !frame.GameOver) ) {
+
+			DeleteWindows();
+			Game2048::ClearScreen();
+
+			GameLayout layout = GetGameLayout(Rows, Cols, game.GetBoardSize());
+
+			// create window for tiles
+			MainWindow = newwin(layout.Board.Height, layout.Board.Width, layout.Board.Row, layout.Board.Col);
+			box(MainWindow, ACS_BULLET, ACS_BULLET);
+
+			// create high score window
+			SideWindow = newwin(layout.HighScore.Height, layout.HighScore.Width, layout.HighScore.Row, layout.HighScore.Col);
+			box(SideWindow, ACS_VLINE, ACS_HLINE);
+
+			GameOverShown = false;
+
+		}
+
+		if( frame.GameOver && !GameOverShown ) {
+			PrintGameOver();
+			GameOverShown = true;
+		}
+
+		int rowStart = 3;
+		int colStart = 3;
+
+		wattron(MainWindow, COLOR_PAIR(30));
+		mvwprintw(MainWindow, rowStart - 1, colStart, "Score: %d", game.GetScore());
+
+		// hint is right after score
+		mvwprintw(MainWindow, rowStart - 1, colStart + 18, "%-10s", frame.Hint.c_str());
+		wattroff(MainWindow, COLOR_PAIR(30));
+
+		// print every tile of board
+		for( int8_t i = 0; i < game.GetBoardSize(); i++ ) {
+			for( int8_t j = 0; j < game.GetBoardSize(); j++ ) {
+
+				// calculate position of tile
+				uint8_t row = rowStart + i * 5;
+				uint8_t col = colStart + j * 10;
+
+				Game2048::PrintTile(MainWindow, row, col, game.GetBoard()[i][j]);
+
+			}
+		}
+
+		wattron(SideWindow, COLOR_PAIR(30));
+		mvwprintw(SideWindow, rowStart - 1, colStart, "%s", HighScoreHeader.c_str());
+		wattroff(SideWindow, COLOR_PAIR(30));
+
+		// print high score
+		for( std::size_t i = 0, len = GetShownCount(frame.HighScores, 10); i < len; i++ ) {
+			mvwprintw(SideWindow, rowStart + i, colStart, "%2d.) %7d", i + 1, frame.HighScores->at(i).Score);
+		}
+
+		if( !frame.Seed.empty() && SeedRow < getmaxy(SideWindow) - 1 ) {
+			mvwprintw(SideWindow, SeedRow, colStart, "%-17s", frame.Seed.c_str());
+		}
+
+		for( std::size_t i = 0; i < frame.Analysis.size() && AnalysisRow + (int) i < getmaxy(SideWindow) - 1; i++ ) {
+
+			// padding overwrites longer line shown before
+			if( i == 0 ) wattron(SideWindow, COLOR_PAIR(30));
+			mvwprintw(SideWindow, AnalysisRow + i, colStart, "%-17s", frame.Analysis[i].c_str());
+			if( i == 0 ) wattroff(SideWindow, COLOR_PAIR(30));
+
+		}
+
+		// screen first, windows are drawn over it
+		wnoutrefresh(stdscr);
+		wnoutrefresh(MainWindow);
+		wnoutrefresh(SideWindow);
+		doupdate();
+
+	}
+
+	void NcursesRenderer::RenderHighScore(const HighScoreFrame &frame) {
+
+		WindowRect rect = GetHighScoreLayout(Rows, Cols);
+
+		if( LayoutPending ) {
+
+			DeleteWindows();
+			Game2048::ClearScreen();
+
+			MainWindow = newwin(rect.Height, rect.Width, rect.Row, rect.Col);
+			box(MainWindow, ACS_BULLET, 0);
+
+		}
+
+		// print high score
+		wattron(MainWindow, COLOR_PAIR(30));
+		mvwprintw(MainWindow, 2, (rect.Width / 2) - HighScoreHeader.size() / 2, "%s", HighScoreHeader.c_str());
+		wattroff(MainWindow, COLOR_PAIR(30));
+
+		// title changes length, rest of its line is cleared
+		wmove(MainWindow, 3, 1);
+		wclrtoeol(MainWindow);
+		mvwprintw(MainWindow, 3, (rect.Width / 2) - Utf8Length(frame.Title) / 2, "%s", frame.Title.c_str());
+
+		std::size_t count = GetShownCount(frame.HighScores, LeaderboardSize);
+
+		for( std::size_t i = 0; i < LeaderboardSize; i++ ) {
+
+			wmove(MainWindow, i + 5, 1);
+			wclrtoeol(MainWindow);
+
+			if( i >= count ) continue;
+
+			std::string line = FormatRecord(i + 1, frame.HighScores->at(i));
+			mvwprintw(MainWindow, i + 5, (rect.Width / 2) - line.size() / 2, "%s", line.c_str());
+
+		}
+
+		// clearing removed right border
+		box(MainWindow, ACS_BULLET, 0);
+
+		int startingRow = LeaderboardSize + 7;
+
+		// print choosable items
+		for( std::size_t i = 0, len = HighScoreMenuOptions.size(); i < len; i++ ) {
+
+			if( frame.SelectedItem == i ) wattron(MainWindow, A_REVERSE); // higlight selected item
+			mvwprintw(MainWindow, startingRow + i, (rect.Width / 2) - HighScoreMenuOptions.at(i).size() / 2, "%s", HighScoreMenuOptions.at(i).c_str());
+			if( frame.SelectedItem == i ) wattroff(MainWindow, A_REVERSE);
+
+		}
+
+		wnoutrefresh(stdscr);
+		wnoutrefresh(MainWindow);
+		doupdate();
+
+	}
+
+	void HeadlessRenderer::RenderGame(const GameFrame &) {}
+
+	void HeadlessRenderer::RenderHighScore(const HighScoreFrame &) {}
+
+	AnsiRenderer::AnsiRenderer(const int descriptor) : Descriptor(descriptor) {}
+
+	AnsiRenderer::~AnsiRenderer() {
+
+		// only terminal which got some frame is restored
+		if( Shown.empty() ) return;
+
+		Buffer = "\x1b[0m\x1b[?25h\x1b[" + std::to_string(Rows) + ";1H\n";
+		Flush();
+
+	}
+
+	void AnsiRenderer::RenderGame(const GameFrame &frame) {
+
+		const Game &game = *frame.CurrentGame;
+		GameLayout layout = GetGameLayout(Rows, Cols, game.GetBoardSize());
+
+		// whole frame is composed again, only output is incremental
+		ClearScreen();
+
+		if( frame.GameOver ) {
+			Print(2, Cols / 2 - GameOver.size() / 2, GameOver, 1);
+		}
+
+		const WindowRect &board = layout.Board;
+		const WindowRect &side = layout.HighScore;
+
+		Box(board, U'·', U'·', true);
+		Box(side, U'│', U'─', true);
+
+		int rowStart = 3;
+		int colStart = 3;
+
+		Print(board.Row + rowStart - 1, board.Col + colStart, Format("Score: %d", game.GetScore()), 30);
+		Print(board.Row + rowStart - 1, board.Col + colStart + 18, frame.Hint, 30);
+
+		for( int8_t i = 0; i < game.GetBoardSize(); i++ ) {
+			for( int8_t j = 0; j < game.GetBoardSize(); j++ ) {
+				PrintTile(board.Row + rowStart + i * 5, board.Col + colStart + j * 10, game.GetBoard()[i][j]);
+			}
+		}
+
+		Print(side.Row + rowStart - 1, side.Col + colStart, HighScoreHeader, 30);
+
+		for( std::size_t i = 0, len = GetShownCount(frame.HighScores, 10); i < len; i++ ) {
+			Print(side.Row + rowStart + i, side.Col + colStart, Format("%2d.) %7d", frame.HighScores->at(i).Score));
+		}
+
+		if( !frame.Seed.empty() && SeedRow < side.Height - 1 ) {
+			Print(side.Row + SeedRow, side.Col + colStart, frame.Seed);
+		}
+
+		for( std::size_t i = 0; i < frame.Analysis.size() && AnalysisRow + (int) i < side.Height - 1; i++ ) {
+			Print(side.Row + AnalysisRow + i, side.Col + colStart, frame.Analysis[i], i == 0 ? 30 : 0);
+		}
+
+		Flush();
+
+	}
+
+	void AnsiRenderer::RenderHighScore(const HighScoreFrame &frame) {
+
+		WindowRect rect = GetHighScoreLayout(Rows, Cols);
+
+		ClearScreen();
+		Box(rect, U'·', U'─', true);
+
+		int center = rect.Col + rect.Width / 2;
+
+		Print(rect.Row + 2, center - HighScoreHeader.size() / 2, HighScoreHeader, 30);
+
+		Print(rect.Row + 3, center - Utf8Length(frame.Title) / 2, frame.Title);
+
+		for( std::size_t i = 0, len = GetShownCount(frame.HighScores, LeaderboardSize); i < len; i++ ) {
+
+			std::string line = FormatRecord(i + 1, frame.HighScores->at(i));
+			Print(rect.Row + i + 5, center - line.size() / 2, line);
+
+		}
+
+		int startingRow = rect.Row + LeaderboardSize + 7;
+
+		for( std::size_t i = 0, len = HighScoreMenuOptions.size(); i < len; i++ ) {
+			Print(startingRow + i, center - HighScoreMenuOptions.at(i).size() / 2, HighScoreMenuOptions.at(i), 0, frame.SelectedItem == i);
+		}
+
+		Flush();
+
+	}
+
+	void AnsiRenderer::ClearScreen() {
+
+		Cells.assign(Rows * Cols, Cell());
+
+		if( Rows < 2 || Cols < 2 ) return;
+
+		// border of stdscr with bullets in corners
+		Box({ 0, 0, Rows, Cols }, U'│', U'─', false);
+
+		Print(Rows - 3, Cols / 2 - PlayerGuide.size() / 2, PlayerGuide, 30);
+		Print(Rows - 2, Cols / 2 - CopyrightInfo.size() / 2, CopyrightInfo, 30);
+
+	}
+
+	void AnsiRenderer::Print(const int row, const int col, const std::string &text, const uint8_t color, const bool reverse) {
+
+		if( row < 0 || row >= Rows ) return;
+
+		int position = col;
+
+		// decode utf-8, every code point takes one cell
+		for( std::size_t i = 0; i < text.size(); position++ ) {
+
+			unsigned char byte = text[i];
+			int length = byte < 0x80 ? 1 : byte < 0xE0 ? 2 : byte < 0xF0 ? 3 : 4;
+
+			char32_t glyph = length == 1 ? byte : byte & (0x7F >> length);
+			for( int j = 1; j < length && i + j < text.size(); j++ ) {
+				glyph = (glyph << 6) | (text[i + j] & 0x3F);
+			}
+
+			i += length;
+
+			if( position < 0 || position >= Cols ) continue;
+			Cells[row * Cols + position] = { glyph, color, reverse };
+
+		}
+
+	}
+
+	void AnsiRenderer::Box(const WindowRect &rect, const char32_t vertical, const char32_t horizontal, const bool corners) {
+
+		int bottom = rect.Row + rect.Height - 1;
+		int right = rect.Col + rect.Width - 1;
+
+		auto put = [&](const int row, const int col, const char32_t glyph) {
+			if( row >= 0 && row < Rows && col >= 0 && col < Cols ) Cells[row * Cols + col] = { glyph, 0, false };
+		};
+
+		for( int col = rect.Col + 1; col < right; col++ ) {
+			put(rect.Row, col, horizontal);
+			put(bottom, col, horizontal);
+		}
+
+		for( int row = rect.Row + 1; row < bottom; row++ ) {
+			put(row, rect.Col, vertical);
+			put(row, right, vertical);
+		}
+
+		put(rect.Row, rect.Col, corners ? U'┌' : U'·');
+		put(rect.Row, right, corners ? U'┐' : U'·');
+		put(bottom, rect.Col, corners ? U'└' : U'·');
+		put(bottom, right, corners ? U'┘' : U'·');
+
+	}
+
+	void AnsiRenderer::PrintTile(const int row, const int col, const uint16_t value) {
+
+		int color = GetExponent(value);
+
+		Print(row, col, "/--------\\", color);
+		Print(row + 1, col, "|        |", color);
+		Print(row + 2, col, value > 0 ? Format("| %5d  |", value) : "|        |", color);
+		Print(row + 3, col, "|        |", color);
+		Print(row + 4, col, "\\--------/", color);
+
+	}
+
+	void AnsiRenderer::Flush() {
+
+		// nothing is known about terminal after resize, it is cleared
+		if( Shown.size() != Cells.size() || LayoutPending ) {
+			Buffer += "\x1b[?25l\x1b[0m\x1b[2J";
+			Shown.assign(Cells.size(), Cell());
+		}
+
+		Cell attributes;
+		int cursorRow = -1;
+		int cursorCol = -1;
+
+		for( int row = 0; row < Rows; row++ ) {
+			for( int col = 0; col < Cols; col++ ) {
+
+				const Cell &cell = Cells[row * Cols + col];
+				if( cell == Shown[row * Cols + col] ) continue;
+
+				if( row != cursorRow || col != cursorCol ) {
+					Buffer += "\x1b[" + std::to_string(row + 1) + ";" + std::to_string(col + 1) + "H";
+				}
+
+				// attributes of first written cell are always set, terminal state is unknown
+				if( cursorRow < 0 || cell.Color != attributes.Color || cell.Reverse != attributes.Reverse ) {
+					AppendAttributes(cell);
+					attributes = cell;
+				}
+
+				AppendGlyph(cell.Glyph);
+
+				cursorRow = row;
+				cursorCol = col + 1;
+
+			}
+		}
+
+		if( cursorRow >= 0 && (attributes.Color != 0 || attributes.Reverse) ) {
+			Buffer += "\x1b[0m";
+		}
+
+		Shown = Cells;
+
+		std::size_t written = 0;
+		while( written < Buffer.size() ) {
+
+			ssize_t result = write(Descriptor, Buffer.data() + written, Buffer.size() - written);
+			Statistics.Writes++;
+
+			if( result < 0 ) {
+				if( errno == EINTR ) continue;
+				break;
+			}
+
+			written += result;
+
+		}
+
+		Statistics.Bytes += written;
+		Buffer.clear();
+
+	}
+
+	void AnsiRenderer::AppendGlyph(const char32_t glyph) {
+
+		if( glyph < 0x80 ) {
+			Buffer += static_cast<char>(glyph);
+		} else if( glyph < 0x800 ) {
+			Buffer += static_cast<char>(0xC0 | (glyph >> 6));
+			Buffer += static_cast<char>(0x80 | (glyph & 0x3F));
+		} else if( glyph < 0x10000 ) {
+			Buffer += static_cast<char>(0xE0 | (glyph >> 12));
+			Buffer += static_cast<char>(0x80 | ((glyph >> 6) & 0x3F));
+			Buffer += static_cast<char>(0x80 | (glyph & 0x3F));
+		} else {
+			Buffer += static_cast<char>(0xF0 | (glyph >> 18));
+			Buffer += static_cast<char>(0x80 | ((glyph >> 12) & 0x3F));
+			Buffer += static_cast<char>(0x80 | ((glyph >> 6) & 0x3F));
+			Buffer += static_cast<char>(0x80 | (glyph & 0x3F));
+		}
+
+	}
+
+	void AnsiRenderer::AppendAttributes(const Cell &cell) {
+
+		Buffer += "\x1b[0";
+
+		// ncurses color numbers are same as ansi ones
+		for( const ColorPair &colorPair : ColorPairs ) {
+
+			if( colorPair.Pair != cell.Color ) continue;
+
+			Buffer += ";3" + std::to_string(colorPair.Foreground) + ";4" + std::to_string(colorPair.Background);
+			break;
+
+		}
+
+		if( cell.Reverse ) Buffer += ";7";
+		Buffer += "m";
+
+	}
+
+	std::unique_ptr<Renderer> CreateRenderer(const std::string &name) {
+
+		if( name == "ncurses" ) return std::make_unique<NcursesRenderer>();
+		if( name == "ansi" ) return std::make_unique<AnsiRenderer>();
+		if( name == "headless" ) return std::make_unique<HeadlessRenderer>();
+
+		return nullptr;
+	}
+
+}
@@ -0,0 +1,240 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ncurses.h>
+#include <unistd.h>
+
+#include "Game.h"
+#include "HighScore.h"
+
+namespace Game2048 {
+
+	struct WindowRect {
+
+		int Row = 0;
+		int Col = 0;
+		int Height = 0;
+		int Width = 0;
+
+	};
+
+	struct GameLayout {
+
+		WindowRect Board;
+		WindowRect HighScore;
+
+	};
+
+	/// <summary>
+	/// Position of board and high score windows of game screen
+	/// </summary>
+	GameLayout GetGameLayout(const int rows, const int cols, const int8_t boardSize);
+
+	/// <summary>
+	/// Position of window of high score screen
+	/// </summary>
+	WindowRect GetHighScoreLayout(const int rows, const int cols);
+
+	/// <summary>
+	/// Everything shown on game screen
+	/// </summary>
+	struct GameFrame {
+
+		const Game *CurrentGame = nullptr;
+
+		// sorted from highest score, only 10 are shown
+		const std::vector<ScoreRecord> *HighScores = nullptr;
+
+		// empty hint is not shown
+		std::string Hint;
+
+		// seed of game under high scores, empty is not shown
+		std::string Seed;
+		bool GameOver = false;
+
+		// post-game analysis under high scores, first line is title, lines which do not fit are left out
+		std::vector<std::string> Analysis;
+
+	};
+
+	/// <summary>
+	/// Everything shown on high score screen
+	/// </summary>
+	struct HighScoreFrame {
+
+		const std::vector<ScoreRecord> *HighScores = nullptr;
+
+		// board size and period of shown records
+		std::string Title;
+
+		// index to HighScoreMenuOptions
+		int8_t SelectedItem = 0;
+
+	};
+
+	struct RenderStatistics {
+
+		uint64_t Frames = 0;
+		uint64_t Nanoseconds = 0;
+
+		// output of backends writing terminal themselves
+		uint64_t Bytes = 0;
+		uint64_t Writes = 0;
+
+	};
+
+	/// <summary>
+	/// Draws screens of game, backends decide how frame gets to terminal
+	/// </summary>
+	class Renderer {
+
+	public:
+
+		virtual ~Renderer() = default;
+
+		/// <summary>
+		/// Sets terminal size, next frame is laid out and drawn completely
+		/// </summary>
+		/// <param name="rows"></param>
+		/// <param name="cols"></param>
+		void Resize(const int rows, const int cols);
+
+		void DrawGame(const GameFrame &frame);
+		void DrawHighScore(const HighScoreFrame &frame);
+
+		const RenderStatistics &GetStatistics() const;
+
+	protected:
+
+		enum Screen {
+			SCREEN_NONE, SCREEN_GAME, SCREEN_HIGH_SCORE
+		};
+
+		virtual void RenderGame(const GameFrame &frame) = 0;
+		virtual void RenderHighScore(const HighScoreFrame &frame) = 0;
+
+		int Rows = 0;
+		int Cols = 0;
+
+		// set after resize and when other screen was drawn last time
+		bool LayoutPending = true;
+
+		RenderStatistics Statistics;
+
+	private:
+
+		void Draw(const Screen screen, const std::function<void()> &render);
+
+		Screen LastScreen = SCREEN_NONE;
+
+	};
+
+	/// <summary>
+	/// Draws to ncurses windows, ncurses has to be initialized
+	/// </summary>
+	class NcursesRenderer : public Renderer {
+
+	public:
+
+		~NcursesRenderer() override;
+
+	protected:
+
+		void RenderGame(const GameFrame &frame) override;
+		void RenderHighScore(const HighScoreFrame &frame) override;
+
+	private:
+
+		void DeleteWindows();
+
+		WINDOW *MainWindow = nullptr;
+		WINDOW *SideWindow = nullptr;
+
+		bool GameOverShown = false;
+
+	};
+
+	/// <summary>
+	/// Draws nothing, measures cost of UI code around rendering
+	/// </summary>
+	class HeadlessRenderer : public Renderer {
+
+	protected:
+
+		void RenderGame(const GameFrame &frame) override;
+		void RenderHighScore(const HighScoreFrame &frame) override;
+
+	};
+
+	/// <summary>
+	/// Composes frame in memory and writes only cells which differ from previous frame,
+	/// whole update is emitted by one write call
+	/// </summary>
+	class AnsiRenderer : public Renderer {
+
+	public:
+
+		AnsiRenderer(const int descriptor = STDOUT_FILENO);
+
+		/// <summary>
+		/// Restores cursor and colors of terminal
+		/// </summary>
+		~AnsiRenderer() override;
+
+	protected:
+
+		void RenderGame(const GameFrame &frame) override;
+		void RenderHighScore(const HighScoreFrame &frame) override;
+
+	private:
+
+		struct Cell {
+
+			char32_t Glyph = U' ';
+			uint8_t Color = 0;
+			bool Reverse = false;
+
+			bool operator==(const Cell &other) const = default;
+
+		};
+
+		void ClearScreen();
+		void Print(const int row, const int col, const std::string &text, const uint8_t color = 0, const bool reverse = false);
+		void Box(const WindowRect &rect, const char32_t vertical, const char32_t horizontal, const bool corners);
+		void PrintTile(const int row, const int col, const uint16_t value);
+		void Flush();
+
+		void AppendGlyph(const char32_t glyph);
+		void AppendAttributes(const Cell &cell);
+
+		int Descriptor;
+
+		// frame being composed and frame shown by terminal
+		std::vector<Cell> Cells;
+		std::vector<Cell> Shown;
+
+		std::string Buffer;
+
+	};
+
+	const std::vector<std::string> RendererNames {
+		"ncurses",
+		"ansi",
+		"headless"
+	};
+
+	/// <summary>
+	/// Creates renderer by its name from RendererNames
+	/// </summary>
+	/// <param name="name"></param>
+	/// <returns>nullptr for unknown name</returns>
+	std::unique_ptr<Renderer> CreateRenderer(const std::string &name);
+
+}
@@ -0,0 +1,243 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "Search.h"
+#include "Arena.h"
+#include "OpeningBook.h"
+#include "PackedBoard.h"
+#include "SearchCache.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace Game2048 {
+
+	ExpectimaxSearch::ExpectimaxSearch(const Evaluator &evaluator, const SearchConfig &config) : PositionEvaluator(evaluator), Config(config) {
+		TranspositionTable.resize(std::size_t(1) << config.TranspositionBits);
+	}
+
+	SearchResult ExpectimaxSearch::Search(const Game &game) {
+
+		if( Config.UseOpeningBook ) {
+
+			const OpeningBook *book = GetDefaultOpeningBook(game.GetBoardSize());
+
+			SearchResult result;
+			float value;
+
+			if( book && book->Lookup(game, result.Move, value, result.Depth) ) {
+				result.Value = value;
+				return result;
+			}
+
+		}
+
+		return SearchMoves(game, game.GetLegalMoves());
+	}
+
+	SearchResult ExpectimaxSearch::SearchMove(const Game &game, const Direction direction) {
+		return SearchMoves(game, game.GetLegalMoves() & DirectionMask(direction));
+	}
+
+	SearchResult ExpectimaxSearch::SearchMoves(const Game &game, const uint8_t moveMask) {
+
+		// finished game or illegal move, there is nothing to search
+		if( moveMask == 0 ) return SearchResult();
+
+		SearchCacheKey cacheKey;
+		Symmetry cacheSymmetry = 0;
+
+		if( Config.UseCache ) {
+
+			cacheKey = SearchCache::GetKey(game, moveMask, Config, PositionEvaluator, cacheSymmetry);
+
+			SearchCacheValue cached;
+
+			if( GetSearchCache().Lookup(cacheKey, cached) ) {
+
+				SearchResult result;
+				result.Move = TransformDirection(cached.Move, InverseSymmetry(cacheSymmetry));
+				result.Value = cached.Value;
+				result.Depth = cached.Depth;
+				result.TimedOut = cached.TimedOut;
+				result.Cached = true;
+
+				return result;
+			}
+
+		}
+
+		Deadline = std::chrono::steady_clock::now() + Config.TimeBudget;
+		Nodes = 0;
+		Aborted = false;
+		Generation++;
+
+		// nodes live in arena of calling thread, everything is freed when search ends
+		NodeArena = &GetThreadArena();
+		NodeArena->ResetHighWater();
+
+		ArenaScope searchScope(*NodeArena);
+		std::size_t arenaStart = NodeArena->GetUsed();
+
+		struct RootMove {
+			Direction Move;
+			double Value;
+		};
+
+		std::vector<RootMove> rootMoves;
+
+		// depth 0 evaluates moves without search, it is the answer if deadline hits before first iteration
+		for( Direction direction : Directions ) {
+
+			if( !(moveMask & DirectionMask(direction)) ) continue;
+
+			ArenaScope scope(*NodeArena);
+
+			Game moved(game, NodeArena);
+			moved.MoveBoard(direction);
+
+			rootMoves.push_back({ direction, PositionEvaluator.Evaluate(moved) });
+
+		}
+
+		auto byValue = [](const RootMove &first, const RootMove &second) {
+			return first.Value > second.Value;
+		};
+
+		std::stable_sort(rootMoves.begin(), rootMoves.end(), byValue);
+
+		SearchResult result;
+		result.Move = rootMoves.front().Move;
+		result.Value = rootMoves.front().Value;
+
+		for( int depth = 1; depth <= Config.MaxDepth && !Aborted; depth++ ) {
+
+			std::vector<RootMove> iterationMoves;
+
+			// moves go in order of previous iteration, unfinished iteration is thrown away
+			for( const RootMove &rootMove : rootMoves ) {
+
+				ArenaScope scope(*NodeArena);
+
+				Game moved(game, NodeArena);
+				moved.MoveBoard(rootMove.Move);
+
+				double value = ChanceNode(moved, depth, 1.0);
+				if( Aborted ) break;
+
+				iterationMoves.push_back({ rootMove.Move, value });
+
+			}
+
+			if( Aborted ) break;
+
+			rootMoves = iterationMoves;
+			std::stable_sort(rootMoves.begin(), rootMoves.end(), byValue);
+
+			result.Move = rootMoves.front().Move;
+			result.Value = rootMoves.front().Value;
+			result.Depth = depth;
+
+		}
+
+		result.Nodes = Nodes;
+		result.TimedOut = Aborted;
+		result.ArenaHighWater = NodeArena->GetHighWater() - arenaStart;
+
+		if( Config.UseCache ) {
+			GetSearchCache().Store(cacheKey, { TransformDirection(result.Move, cacheSymmetry), result.Value, result.Depth, result.TimedOut });
+		}
+
+		return result;
+	}
+
+	double ExpectimaxSearch::MaxNode(const Game &game, const int depth, const double probability) {
+
+		if( IsAborted() ) return 0;
+
+		// lost position is worse than any evaluated one
+		if( game.GetLegalMoves() == 0 ) return 0;
+
+		if( depth == 0 ) return PositionEvaluator.Evaluate(game);
+
+		double best = 0;
+
+		for( Direction direction : Directions ) {
+
+			if( !(game.GetLegalMoves() & DirectionMask(direction)) ) continue;
+
+			ArenaScope scope(*NodeArena);
+
+			Game moved(game, NodeArena);
+			moved.MoveBoard(direction);
+
+			best = std::max(best, ChanceNode(moved, depth, probability));
+			if( Aborted ) return 0;
+
+		}
+
+		return best;
+	}
+
+	double ExpectimaxSearch::ChanceNode(const Game &game, const int depth, const double probability) {
+
+		if( IsAborted() ) return 0;
+
+		if( probability < Config.MinProbability ) return PositionEvaluator.Evaluate(game);
+
+		uint64_t key = GetKey(game);
+
+		// multiplicative hashing spreads packed boards over whole table
+		CachedValue &cached = TranspositionTable[(key * 0x9E3779B97F4A7C15) >> (64 - Config.TranspositionBits)];
+
+		if( cached.Generation == Generation && cached.Key == key && cached.Depth >= depth ) {
+			return cached.Value;
+		}
+
+		SpawnOutcomes outcomes;
+		std::size_t count = game.GetSpawnOutcomes(outcomes);
+
+		double value = 0;
+
+		for( std::size_t i = 0; i < count; i++ ) {
+
+			const SpawnOutcome &outcome = outcomes[i];
+
+			ArenaScope scope(*NodeArena);
+
+			Game spawned(game, NodeArena);
+			spawned.AddTile(outcome.Row, outcome.Col, outcome.Value);
+
+			value += outcome.Probability * MaxNode(spawned, depth - 1, probability * outcome.Probability);
+			if( Aborted ) return 0;
+
+		}
+
+		cached = { key, value, depth, Generation };
+
+		return value;
+	}
+
+	bool ExpectimaxSearch::IsAborted() {
+
+		Nodes++;
+
+		if( !Aborted && std::chrono::steady_clock::now() >= Deadline ) {
+			Aborted = true;
+		}
+
+		return Aborted;
+	}
+
+	uint64_t ExpectimaxSearch::GetKey(const Game &game) const {
+
+		if( IsPackedBoardSize(game.GetBoardSize()) ) {
+
+			Symmetry symmetry;
+			return CanonicalizeBoard(PackBoard(game.GetBoard()), game.GetBoardSize(), symmetry);
+
+		}
+
+		return game.GetHash();
+	}
+
+}
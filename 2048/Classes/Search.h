@@ -0,0 +1,133 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "Arena.h"
+#include "Evaluator.h"
+#include "Game.h"
+
+namespace Game2048 {
+
+	struct SearchConfig {
+
+		// Search returns best move found until this time runs out
+		std::chrono::microseconds TimeBudget { 5000 };
+
+		// Deepest iteration in player moves
+		int MaxDepth = 8;
+
+		// Positions reached with smaller probability are evaluated without further search
+		double MinProbability = 0.0001;
+
+		// Transposition table has 2^TranspositionBits entries
+		int TranspositionBits = 16;
+
+		// Positions of default opening book are answered without search
+		bool UseOpeningBook = false;
+
+		// Results are kept in process-wide search cache, repeated search of the same or transposed position returns at once
+		bool UseCache = false;
+
+	};
+
+	struct SearchResult {
+
+		Direction Move = UP;
+
+		// Expected evaluation after Move
+		double Value = 0;
+
+		// Deepest fully searched iteration, 0 means only moves themselves were evaluated
+		int Depth = 0;
+
+		uint64_t Nodes = 0;
+
+		// Deadline stopped iteration deeper than Depth
+		bool TimedOut = false;
+
+		// Most bytes of nodes allocated at once
+		std::size_t ArenaHighWater = 0;
+
+		// Result comes from search cache, no node was searched
+		bool Cached = false;
+
+	};
+
+	/// <summary>
+	/// Iterative-deepening expectimax over Game::MoveBoard and every possible new tile
+	/// (any empty cell, 2 or 4 with the same probability as AddRandomTile).
+	/// Deadline is checked in every node, move is always returned from last finished iteration.
+	/// </summary>
+	class ExpectimaxSearch {
+
+	public:
+
+		ExpectimaxSearch(const Evaluator &evaluator, const SearchConfig &config);
+
+		/// <summary>
+		/// Finds best move of game which has at least one legal move
+		/// </summary>
+		/// <param name="game"></param>
+		/// <returns></returns>
+		SearchResult Search(const Game &game);
+
+		/// <summary>
+		/// Searches only given legal move of game, value is comparable between moves searched
+		/// with the same config. Opening book is not used.
+		/// </summary>
+		/// <param name="game"></param>
+		/// <param name="direction">legal move of game</param>
+		/// <returns></returns>
+		SearchResult SearchMove(const Game &game, const Direction direction);
+
+	private:
+
+		struct CachedValue {
+			uint64_t Key = 0;
+			double Value = 0;
+			int Depth = 0;
+			uint32_t Generation = 0;
+		};
+
+		/// <summary>
+		/// Iterative deepening over legal moves of game selected by mask,
+		/// default result without searching when mask is empty
+		/// </summary>
+		SearchResult SearchMoves(const Game &game, const uint8_t moveMask);
+
+		double MaxNode(const Game &game, const int depth, const double probability);
+		double ChanceNode(const Game &game, const int depth, const double probability);
+
+		/// <summary>
+		/// Counts node and checks deadline
+		/// </summary>
+		/// <returns>true if search has to stop</returns>
+		bool IsAborted();
+
+		/// <summary>
+		/// Key of position, equivalent packed boards share it
+		/// </summary>
+		uint64_t GetKey(const Game &game) const;
+
+		const Evaluator &PositionEvaluator;
+		SearchConfig Config;
+
+		// Storage of nodes of running search
+		Arena *NodeArena = nullptr;
+
+		std::chrono::steady_clock::time_point Deadline;
+		uint64_t Nodes = 0;
+		bool Aborted = false;
+
+		// Values of positions after move, entries of older generation are empty,
+		// so new search does not have to clear table
+		std::vector<CachedValue> TranspositionTable;
+		uint32_t Generation = 0;
+
+	};
+
+}
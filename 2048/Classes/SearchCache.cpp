@@ -0,0 +1,145 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "SearchCache.h"
+
+#include <bit>
+
+namespace Game2048 {
+
+	namespace {
+
+		// list node and index node with its bucket come on top of entry itself
+		const std::size_t EntryBytes = sizeof(std::pair<SearchCacheKey, SearchCacheValue>) + 6 * sizeof(void *);
+
+		uint64_t Mix(uint64_t hash, const uint64_t value) {
+			hash ^= value + 0x9E3779B97F4A7C15 + (hash << 6) + (hash >> 2);
+			return hash;
+		}
+
+	}
+
+	SearchCache::SearchCache(const std::size_t bytes) : Capacity(bytes / EntryBytes) {}
+
+	bool SearchCache::Lookup(const SearchCacheKey &key, SearchCacheValue &value) {
+
+		std::lock_guard<std::mutex> lock(Mutex);
+
+		auto found = Index.find(key);
+
+		if( found == Index.end() ) {
+			Misses++;
+			return false;
+		}
+
+		Entries.splice(Entries.begin(), Entries, found->second);
+		value = found->second->second;
+		Hits++;
+
+		return true;
+	}
+
+	void SearchCache::Store(const SearchCacheKey &key, const SearchCacheValue &value) {
+
+		std::lock_guard<std::mutex> lock(Mutex);
+
+		if( Capacity == 0 ) return;
+
+		auto found = Index.find(key);
+
+		// other thread could search the same position meanwhile
+		if( found != Index.end() ) {
+			found->second->second = value;
+			Entries.splice(Entries.begin(), Entries, found->second);
+			return;
+		}
+
+		Entries.emplace_front(key, value);
+		Index[key] = Entries.begin();
+
+		Evict();
+
+	}
+
+	void SearchCache::SetBudget(const std::size_t bytes) {
+
+		std::lock_guard<std::mutex> lock(Mutex);
+
+		Capacity = bytes / EntryBytes;
+		Evict();
+
+	}
+
+	void SearchCache::Clear() {
+
+		std::lock_guard<std::mutex> lock(Mutex);
+
+		Entries.clear();
+		Index.clear();
+
+	}
+
+	SearchCacheStatistics SearchCache::GetStatistics() const {
+
+		std::lock_guard<std::mutex> lock(Mutex);
+		return { Hits, Misses, Entries.size(), Capacity };
+
+	}
+
+	SearchCacheKey SearchCache::GetKey(const Game &game, const uint8_t moveMask, const SearchConfig &config, const Evaluator &evaluator, Symmetry &symmetry) {
+
+		SearchCacheKey key;
+
+		// transposition keeps moves, spawns and evaluation, so transposed board has the same search
+		symmetry = 0;
+
+		if( IsPackedBoardSize(game.GetBoardSize()) ) {
+			key.Board = CanonicalizeBoard(PackBoard(game.GetBoard()), game.GetBoardSize(), symmetry);
+		} else {
+			key.Board = game.GetHash();
+		}
+
+		for( Direction direction : Directions ) {
+			if( moveMask & DirectionMask(direction) ) key.MoveMask |= DirectionMask(TransformDirection(direction, symmetry));
+		}
+
+		key.BoardSize = game.GetBoardSize();
+		key.MaxDepth = config.MaxDepth;
+		key.TimeBudgetMicroseconds = config.TimeBudget.count();
+		key.MinProbability = config.MinProbability;
+		key.TranspositionBits = config.TranspositionBits;
+		key.TwoProbability = game.GetTwoProbability();
+		key.PositionEvaluator = &evaluator;
+
+		return key;
+	}
+
+	std::size_t SearchCache::KeyHash::operator()(const SearchCacheKey &key) const {
+
+		uint64_t hash = key.Board * 0x9E3779B97F4A7C15;
+		hash = Mix(hash, (uint64_t(key.BoardSize) << 8) | key.MoveMask);
+		hash = Mix(hash, key.MaxDepth);
+		hash = Mix(hash, key.TimeBudgetMicroseconds);
+		hash = Mix(hash, std::bit_cast<uint64_t>(key.MinProbability));
+		hash = Mix(hash, key.TranspositionBits);
+		hash = Mix(hash, std::bit_cast<uint64_t>(key.TwoProbability));
+		hash = Mix(hash, reinterpret_cast<uintptr_t>(key.PositionEvaluator));
+
+		return hash;
+	}
+
+	void SearchCache::Evict() {
+
+		while( Entries.size() > Capacity ) {
+			Index.erase(Entries.back().first);
+			Entries.pop_back();
+		}
+
+	}
+
+	SearchCache &GetSearchCache() {
+
+		static SearchCache cache;
+		return cache;
+	}
+
+}
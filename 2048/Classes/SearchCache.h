@@ -0,0 +1,136 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "Game.h"
+#include "PackedBoard.h"
+#include "Search.h"
+
+namespace Game2048 {
+
+	// Memory of process-wide search cache unless changed by SetBudget
+	const std::size_t DefaultSearchCacheBytes = 16 << 20;
+
+	/// <summary>
+	/// Everything deciding result of search, searches differing in anything else share entries
+	/// </summary>
+	struct SearchCacheKey {
+
+		// Canonical packed board, Zobrist hash of boards which do not fit
+		uint64_t Board = 0;
+		int8_t BoardSize = 0;
+
+		// Searched root moves (MoveMask bits) on canonical board
+		uint8_t MoveMask = 0;
+
+		int MaxDepth = 0;
+		int64_t TimeBudgetMicroseconds = 0;
+		double MinProbability = 0;
+		int TranspositionBits = 0;
+		double TwoProbability = 0;
+
+		// Evaluator used by search, cache is shared by all of them
+		const Evaluator *PositionEvaluator = nullptr;
+
+		bool operator==(const SearchCacheKey &other) const = default;
+
+	};
+
+	/// <summary>
+	/// Best move of cached search, on canonical board of its key
+	/// </summary>
+	struct SearchCacheValue {
+
+		Direction Move = UP;
+		double Value = 0;
+		int Depth = 0;
+		bool TimedOut = false;
+
+	};
+
+	struct SearchCacheStatistics {
+		uint64_t Hits = 0;
+		uint64_t Misses = 0;
+		std::size_t Entries = 0;
+		std::size_t Capacity = 0;
+	};
+
+	/// <summary>
+	/// Least recently used results of whole searches bounded by memory budget. Hints, autoplay and
+	/// analysis asking for position searched before get its result without search. Thread safe.
+	/// </summary>
+	class SearchCache {
+
+	public:
+
+		SearchCache(const std::size_t bytes = DefaultSearchCacheBytes);
+
+		SearchCache(const SearchCache &) = delete;
+		SearchCache &operator=(const SearchCache &) = delete;
+
+		/// <summary>
+		/// Finds result of search, found entry becomes most recently used
+		/// </summary>
+		/// <returns>false if position was not searched or was evicted</returns>
+		bool Lookup(const SearchCacheKey &key, SearchCacheValue &value);
+
+		/// <summary>
+		/// Stores result of search, least recently used entries are evicted to keep budget
+		/// </summary>
+		void Store(const SearchCacheKey &key, const SearchCacheValue &value);
+
+		/// <summary>
+		/// Changes memory budget, 0 turns cache off. Entries over new budget are evicted.
+		/// </summary>
+		void SetBudget(const std::size_t bytes);
+
+		void Clear();
+
+		SearchCacheStatistics GetStatistics() const;
+
+		/// <summary>
+		/// Key of search of given moves of game. Board and its transposition share key, so moves
+		/// are stored as TransformDirection(move, symmetry) and read back with InverseSymmetry(symmetry).
+		/// </summary>
+		/// <param name="game"></param>
+		/// <param name="moveMask"></param>
+		/// <param name="config"></param>
+		/// <param name="evaluator"></param>
+		/// <param name="symmetry">returns symmetry which transforms board of game to board of key</param>
+		/// <returns></returns>
+		static SearchCacheKey GetKey(const Game &game, const uint8_t moveMask, const SearchConfig &config, const Evaluator &evaluator, Symmetry &symmetry);
+
+	private:
+
+		struct KeyHash {
+			std::size_t operator()(const SearchCacheKey &key) const;
+		};
+
+		using Entry = std::pair<SearchCacheKey, SearchCacheValue>;
+
+		// Most recently used first
+		std::list<Entry> Entries;
+		std::unordered_map<SearchCacheKey, std::list<Entry>::iterator, KeyHash> Index;
+
+		std::size_t Capacity = 0;
+
+		uint64_t Hits = 0;
+		uint64_t Misses = 0;
+
+		mutable std::mutex Mutex;
+
+		void Evict();
+
+	};
+
+	/// <summary>
+	/// Cache shared by all searches of process which have SearchConfig::UseCache
+	/// </summary>
+	SearchCache &GetSearchCache();
+
+}
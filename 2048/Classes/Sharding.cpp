@@ -0,0 +1,239 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "Sharding.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <csignal>
+
+#include <sched.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace Game2048 {
+
+	namespace {
+
+		uint64_t HashBytes(const void *data, const std::size_t size, uint64_t hash = 14695981039346656037ull) {
+
+			// FNV-1a
+			const uint8_t *bytes = static_cast<const uint8_t *>(data);
+
+			for( std::size_t i = 0; i < size; i++ ) {
+				hash = (hash ^ bytes[i]) * 1099511628211ull;
+			}
+
+			return hash;
+		}
+
+		uint64_t GetConfigHash(const SimulationConfig &simulation) {
+
+			std::string description = std::to_string(simulation.Games) + ":" + std::to_string(simulation.Seed) + ":" +
+				std::to_string(simulation.TwoProbability) + ":";
+
+			for( int8_t boardSize : simulation.BoardSizes ) {
+				description += std::to_string(boardSize) + ",";
+			}
+
+			description += ":";
+
+			for( const std::string &policy : simulation.Policies ) {
+				description += policy + ",";
+			}
+
+			return HashBytes(description.data(), description.size());
+		}
+
+		/// <summary>
+		/// Header of shard with its seed range, seeds are split as evenly as possible
+		/// </summary>
+		ShardHeader GetShardHeader(const ShardConfig &config, const uint32_t shard) {
+
+			ShardHeader header {};
+			std::memcpy(header.Magic, ShardMagic, sizeof(ShardMagic));
+			header.Version = ShardVersion;
+			header.ShardIndex = shard;
+			header.ShardCount = config.Shards;
+			header.ConfigHash = GetConfigHash(config.Simulation);
+			header.SeedBegin = config.Simulation.Games * shard / config.Shards;
+			header.SeedEnd = config.Simulation.Games * (shard + 1) / config.Shards;
+
+			return header;
+		}
+
+		void PinToCpus(const std::vector<int> &cpus) {
+
+			cpu_set_t set;
+			CPU_ZERO(&set);
+
+			for( int cpu : cpus ) {
+				if( cpu >= 0 && cpu < CPU_SETSIZE ) CPU_SET(cpu, &set);
+			}
+
+			// worker still runs unpinned if set is not allowed
+			sched_setaffinity(0, sizeof(set), &set);
+
+		}
+
+	}
+
+	std::string GetShardFile(const ShardConfig &config, const uint32_t shard) {
+		return (std::filesystem::path(config.Directory) / ("shard-" + std::to_string(shard) + "-of-" + std::to_string(config.Shards) + ".bin")).string();
+	}
+
+	bool RunShard(const ShardConfig &config, const uint32_t shard) {
+
+		ShardHeader header = GetShardHeader(config, shard);
+
+		SimulationConfig simulation = config.Simulation;
+		simulation.Seed += header.SeedBegin;
+		simulation.Games = header.SeedEnd - header.SeedBegin;
+
+		std::vector<uint8_t> payload;
+		EncodeStatistics(RunSimulation(simulation), payload);
+
+		header.PayloadSize = payload.size();
+		header.PayloadChecksum = HashBytes(payload.data(), payload.size());
+
+		// other machines may write their shards to the same directory, temporary name is unique
+		std::string file = GetShardFile(config, shard);
+		std::string temporaryFile = file + ".tmp" + std::to_string(getpid());
+
+		std::ofstream fileStream(temporaryFile, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+		fileStream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		fileStream.write(reinterpret_cast<const char *>(payload.data()), payload.size());
+		fileStream.close();
+
+		if( fileStream.fail() || std::rename(temporaryFile.c_str(), file.c_str()) != 0 ) {
+			std::remove(temporaryFile.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	bool ReadShard(const ShardConfig &config, const uint32_t shard, StatisticsTable &statistics) {
+
+		std::ifstream fileStream(GetShardFile(config, shard), std::ifstream::binary);
+		if( !fileStream.is_open() ) return false;
+
+		ShardHeader expected = GetShardHeader(config, shard);
+		ShardHeader header;
+
+		if( !fileStream.read(reinterpret_cast<char *>(&header), sizeof(header)) ) return false;
+
+		if( std::memcmp(header.Magic, ShardMagic, sizeof(ShardMagic)) != 0 || header.Version != ShardVersion ||
+			header.ShardIndex != shard || header.ShardCount != config.Shards || header.ConfigHash != expected.ConfigHash ||
+			header.SeedBegin != expected.SeedBegin || header.SeedEnd != expected.SeedEnd ) return false;
+
+		// payload has to end exactly with file
+		std::vector<uint8_t> payload(header.PayloadSize);
+
+		if( !fileStream.read(reinterpret_cast<char *>(payload.data()), payload.size()) || fileStream.peek() != EOF ) return false;
+		if( HashBytes(payload.data(), payload.size()) != header.PayloadChecksum ) return false;
+
+		return DecodeStatistics(payload, statistics);
+	}
+
+	ShardReport RunShardedSimulation(const ShardConfig &config) {
+
+		auto start = std::chrono::steady_clock::now();
+
+		ShardReport report;
+
+		std::vector<uint32_t> pending;
+
+		for( uint32_t shard = config.MachineIndex; shard < config.Shards; shard += std::max(1u, config.MachineCount) ) {
+
+			StatisticsTable statistics;
+
+			if( ReadShard(config, shard, statistics) ) {
+				report.Reused++;
+			} else {
+				pending.push_back(shard);
+			}
+
+		}
+
+		if( config.Workers > 0 ) {
+
+			// children inherit buffered output, it must not be written twice
+			fflush(stdout);
+			fflush(stderr);
+
+			std::map<pid_t, uint32_t> running;
+			std::size_t next = 0;
+			unsigned worker = 0;
+
+			while( next < pending.size() || !running.empty() ) {
+
+				if( next < pending.size() && running.size() < config.Workers ) {
+
+					uint32_t shard = pending[next++];
+					std::vector<int> cpus = config.CpuSets.empty() ? std::vector<int>() : config.CpuSets[worker++ % config.CpuSets.size()];
+
+					pid_t pid = fork();
+
+					if( pid == 0 ) {
+
+						// killed coordinator takes its workers with it, next run resumes their shards
+						prctl(PR_SET_PDEATHSIG, SIGKILL);
+
+						if( !cpus.empty() ) PinToCpus(cpus);
+
+						// worker leaves without destructors and atexit handlers of coordinator
+						_exit(RunShard(config, shard) ? EXIT_SUCCESS : EXIT_FAILURE);
+
+					}
+
+					if( pid < 0 ) {
+						report.Failed++;
+					} else {
+						running[pid] = shard;
+					}
+
+					continue;
+				}
+
+				int status;
+				pid_t pid = waitpid(-1, &status, 0);
+
+				if( pid < 0 ) break;
+
+				if( running.erase(pid) == 0 ) continue;
+
+				if( WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS ) {
+					report.Completed++;
+				} else {
+					report.Failed++;
+				}
+
+			}
+
+		}
+
+		// shards of other machines are merged too, whatever is missing is counted
+		for( uint32_t shard = 0; shard < config.Shards; shard++ ) {
+
+			StatisticsTable statistics;
+
+			if( ReadShard(config, shard, statistics) ) {
+				MergeStatistics(report.Statistics, statistics);
+			} else {
+				report.Missing++;
+			}
+
+		}
+
+		report.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return report;
+	}
+
+}
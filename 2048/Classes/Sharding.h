@@ -0,0 +1,114 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Simulation.h"
+#include "Statistics.h"
+
+namespace Game2048 {
+
+	/// <summary>
+	/// Beginning of shard file, encoded statistics of shard follow it
+	/// </summary>
+	struct ShardHeader {
+
+		char Magic[8];
+		uint32_t Version;
+
+		uint32_t ShardIndex;
+		uint32_t ShardCount;
+		uint32_t Reserved;
+
+		// Hash of board sizes, policies, games and seed of whole simulation
+		uint64_t ConfigHash;
+
+		// Seeds played by shard are Seed + SeedBegin ... Seed + SeedEnd - 1
+		uint64_t SeedBegin;
+		uint64_t SeedEnd;
+
+		uint64_t PayloadSize;
+		uint64_t PayloadChecksum;
+
+	};
+
+	const char ShardMagic[8] { '2', '0', '4', '8', 'S', 'H', 'R', 'D' };
+	const uint32_t ShardVersion = 1;
+
+	/// <summary>
+	/// Simulation split to shards of disjoint seed ranges which are played by worker processes.
+	/// Shard file appears only when shard is finished, so run of the same config on the same
+	/// directory continues where previous run stopped.
+	/// </summary>
+	struct ShardConfig {
+
+		// Whole simulation, Threads are threads of every worker
+		SimulationConfig Simulation;
+
+		// Directory with shard files, may be shared by several machines
+		std::string Directory;
+
+		uint32_t Shards = 1;
+
+		// Worker processes running at once, 0 only merges existing shards
+		unsigned Workers = 1;
+
+		// Worker w is pinned to CPU set w % CpuSets.size(), no set means no pinning
+		std::vector<std::vector<int>> CpuSets;
+
+		// This machine plays shards whose index % MachineCount == MachineIndex
+		uint32_t MachineIndex = 0;
+		uint32_t MachineCount = 1;
+
+	};
+
+	struct ShardReport {
+
+		// Shards finished by earlier runs
+		uint32_t Reused = 0;
+
+		// Shards played by this run
+		uint32_t Completed = 0;
+
+		// Workers which did not write their shard
+		uint32_t Failed = 0;
+
+		// Shards without valid file after run, statistics are not complete if any is missing
+		uint32_t Missing = 0;
+
+		// Merged statistics of all valid shards
+		StatisticsTable Statistics;
+
+		double Seconds = 0;
+
+	};
+
+	/// <summary>
+	/// Name of shard file in shard directory
+	/// </summary>
+	std::string GetShardFile(const ShardConfig &config, const uint32_t shard);
+
+	/// <summary>
+	/// Plays shard in this process and writes its file through temporary file
+	/// </summary>
+	/// <returns>false if file cannot be written</returns>
+	bool RunShard(const ShardConfig &config, const uint32_t shard);
+
+	/// <summary>
+	/// Reads shard file written for the same config
+	/// </summary>
+	/// <returns>false for missing, damaged or foreign shard</returns>
+	bool ReadShard(const ShardConfig &config, const uint32_t shard, StatisticsTable &statistics);
+
+	/// <summary>
+	/// Forks workers for every shard of this machine without valid file, waits for them
+	/// and merges all shards
+	/// </summary>
+	/// <param name="config"></param>
+	/// <returns></returns>
+	ShardReport RunShardedSimulation(const ShardConfig &config);
+
+}
@@ -0,0 +1,99 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "Simulation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace Game2048 {
+
+	// games claimed by thread at once, keeps shared counter out of profiles
+	const uint64_t SimulationChunk = 16;
+
+	GameSummary SimulateGame(Game &game, Policy &policy) {
+
+		auto start = std::chrono::steady_clock::now();
+
+		GameSummary summary;
+
+		while( game.GetLegalMoves() != 0 ) {
+
+			game.MoveBoard(policy.ChooseMove(game));
+			game.AddRandomTile();
+
+			summary.Moves++;
+
+		}
+
+		auto duration = std::chrono::steady_clock::now() - start;
+
+		summary.Score = game.GetScore();
+		summary.MaxTile = game.GetMaxTile();
+		summary.DurationMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+
+		return summary;
+	}
+
+	StatisticsTable RunSimulation(const SimulationConfig &config) {
+
+		uint64_t combinations = config.BoardSizes.size() * config.Policies.size();
+		uint64_t totalGames = combinations * config.Games;
+
+		std::atomic<uint64_t> nextGame = 0;
+
+		unsigned threadCount = std::max(1u, config.Threads);
+		std::vector<StatisticsTable> threadStatistics(threadCount);
+		std::vector<std::thread> threads;
+
+		for( unsigned t = 0; t < threadCount; t++ ) {
+
+			threads.emplace_back([&, t]() {
+
+				StatisticsTable &statistics = threadStatistics[t];
+
+				while( true ) {
+
+					uint64_t first = nextGame.fetch_add(SimulationChunk);
+					if( first >= totalGames ) break;
+
+					for( uint64_t i = first; i < std::min(first + SimulationChunk, totalGames); i++ ) {
+
+						uint64_t combination = i / config.Games;
+						uint64_t seed = config.Seed + i % config.Games;
+
+						int8_t boardSize = config.BoardSizes[combination / config.Policies.size()];
+						const std::string &policyName = config.Policies[combination % config.Policies.size()];
+
+						auto policy = CreatePolicy(policyName, GetPolicySeed(seed));
+
+						Game game(boardSize, seed);
+						game.SetTwoProbability(config.TwoProbability);
+						game.StartGame();
+
+						statistics[{ boardSize, policyName }].Add(SimulateGame(game, *policy));
+
+					}
+
+				}
+
+			});
+
+		}
+
+		for( std::thread &thread : threads ) {
+			thread.join();
+		}
+
+		// every thread is finished, merging needs no locking
+		StatisticsTable result;
+
+		for( const StatisticsTable &statistics : threadStatistics ) {
+			MergeStatistics(result, statistics);
+		}
+
+		return result;
+	}
+
+}
@@ -0,0 +1,52 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Game.h"
+#include "Policy.h"
+#include "Statistics.h"
+
+namespace Game2048 {
+
+	/// <summary>
+	/// Batch of automatically played games
+	/// </summary>
+	struct SimulationConfig {
+
+		std::vector<int8_t> BoardSizes { 4 };
+		std::vector<std::string> Policies { "random" };
+
+		// Games played by every policy on every board size
+		uint64_t Games = 1000;
+
+		unsigned Threads = 1;
+
+		// Game i is seeded by Seed + i, so every policy plays the same seeds
+		uint64_t Seed = 0;
+
+		// Probability that new tile is 2 and not 4
+		double TwoProbability = DefaultTwoProbability;
+
+	};
+
+	/// <summary>
+	/// Plays already started game with given policy until no move is possible
+	/// </summary>
+	/// <param name="game"></param>
+	/// <param name="policy"></param>
+	/// <returns></returns>
+	GameSummary SimulateGame(Game &game, Policy &policy);
+
+	/// <summary>
+	/// Plays all games of config across threads, every thread aggregates its own statistics
+	/// which are merged after all threads finish
+	/// </summary>
+	/// <param name="config"></param>
+	/// <returns>statistics of every board size and policy</returns>
+	StatisticsTable RunSimulation(const SimulationConfig &config);
+
+}
@@ -0,0 +1,399 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "Statistics.h"
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+namespace Game2048 {
+
+	namespace {
+
+		void PutVarint(std::vector<uint8_t> &buffer, uint64_t value) {
+
+			// 7 bits per byte, high bit marks next byte
+			while( value >= 0x80 ) {
+				buffer.push_back(static_cast<uint8_t>(value) | 0x80);
+				value >>= 7;
+			}
+
+			buffer.push_back(static_cast<uint8_t>(value));
+
+		}
+
+		bool GetVarint(const uint8_t *&data, const uint8_t *end, uint64_t &value) {
+
+			value = 0;
+
+			for( int shift = 0; shift < 64 && data < end; shift += 7 ) {
+
+				uint8_t byte = *data++;
+				value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+
+				if( !(byte & 0x80) ) return true;
+
+			}
+
+			return false;
+		}
+
+	}
+
+	std::size_t Histogram::GetBucket(const uint64_t value) {
+
+		if( value < 16 ) return value;
+
+		// power of two and 3 bits right after the leading one
+		std::size_t exponent = std::bit_width(value) - 1;
+		std::size_t subBucket = (value >> (exponent - 3)) & 7;
+
+		return 16 + (exponent - 4) * 8 + subBucket;
+	}
+
+	uint64_t Histogram::GetBucketLowerBound(const std::size_t bucket) {
+
+		if( bucket < 16 ) return bucket;
+
+		std::size_t exponent = (bucket - 16) / 8 + 4;
+		uint64_t subBucket = (bucket - 16) % 8;
+
+		return (8 + subBucket) << (exponent - 3);
+	}
+
+	uint64_t Histogram::GetBucketUpperBound(const std::size_t bucket) {
+
+		if( bucket < 16 ) return bucket;
+
+		std::size_t exponent = (bucket - 16) / 8 + 4;
+
+		return GetBucketLowerBound(bucket) + ((uint64_t) 1 << (exponent - 3)) - 1;
+	}
+
+	void Histogram::Add(const uint64_t value) {
+
+		Buckets[GetBucket(value)]++;
+
+		Count++;
+		Sum += value;
+		Min = std::min(Min, value);
+		Max = std::max(Max, value);
+
+	}
+
+	void Histogram::Merge(const Histogram &other) {
+
+		for( std::size_t i = 0; i < BucketCount; i++ ) {
+			Buckets[i] += other.Buckets[i];
+		}
+
+		Count += other.Count;
+		Sum += other.Sum;
+		Min = std::min(Min, other.Min);
+		Max = std::max(Max, other.Max);
+
+	}
+
+	uint64_t Histogram::GetCount() const {
+		return this->Count;
+	}
+
+	uint64_t Histogram::GetMin() const {
+		return Count > 0 ? this->Min : 0;
+	}
+
+	uint64_t Histogram::GetMax() const {
+		return this->Max;
+	}
+
+	double Histogram::GetMean() const {
+		return Count > 0 ? (double) Sum / Count : 0.0;
+	}
+
+	uint64_t Histogram::GetPercentile(const double fraction) const {
+
+		if( Count == 0 ) return 0;
+
+		uint64_t target = std::max<uint64_t>(1, fraction * Count);
+		uint64_t seen = 0;
+
+		for( std::size_t i = 0; i < BucketCount; i++ ) {
+
+			seen += Buckets[i];
+
+			if( seen >= target ) {
+				return std::clamp(GetBucketLowerBound(i), GetMin(), Max);
+			}
+
+		}
+
+		return Max;
+	}
+
+	uint64_t Histogram::GetBucketCount(const std::size_t bucket) const {
+		return this->Buckets[bucket];
+	}
+
+	void Histogram::Encode(std::vector<uint8_t> &buffer) const {
+
+		PutVarint(buffer, Count);
+		PutVarint(buffer, Sum);
+		PutVarint(buffer, Min);
+		PutVarint(buffer, Max);
+
+		std::size_t used = std::count_if(Buckets.begin(), Buckets.end(), [](const uint64_t count) { return count > 0; });
+		PutVarint(buffer, used);
+
+		// bucket index as distance from previous used bucket
+		std::size_t previous = 0;
+
+		for( std::size_t i = 0; i < BucketCount; i++ ) {
+
+			if( Buckets[i] == 0 ) continue;
+
+			PutVarint(buffer, i - previous);
+			PutVarint(buffer, Buckets[i]);
+
+			previous = i;
+
+		}
+
+	}
+
+	bool Histogram::Decode(const uint8_t *&data, const uint8_t *end) {
+
+		Histogram decoded;
+		uint64_t used;
+
+		if( !GetVarint(data, end, decoded.Count) || !GetVarint(data, end, decoded.Sum) || !GetVarint(data, end, decoded.Min) ||
+			!GetVarint(data, end, decoded.Max) || !GetVarint(data, end, used) || used > BucketCount ) return false;
+
+		uint64_t bucket = 0;
+
+		for( uint64_t i = 0; i < used; i++ ) {
+
+			uint64_t distance, count;
+			if( !GetVarint(data, end, distance) || !GetVarint(data, end, count) ) return false;
+
+			bucket += distance;
+			if( bucket >= BucketCount ) return false;
+
+			decoded.Buckets[bucket] = count;
+
+		}
+
+		*this = decoded;
+
+		return true;
+	}
+
+	void GameStatistics::Add(const GameSummary &summary) {
+
+		Score.Add(summary.Score);
+		MaxTile.Add(summary.MaxTile);
+		Moves.Add(summary.Moves);
+		Duration.Add(summary.DurationMicroseconds);
+
+		for( std::size_t exponent = 1; exponent <= MaxExponent && (1u << exponent) <= summary.MaxTile; exponent++ ) {
+			TileReached[exponent]++;
+		}
+
+	}
+
+	void GameStatistics::Merge(const GameStatistics &other) {
+
+		Score.Merge(other.Score);
+		MaxTile.Merge(other.MaxTile);
+		Moves.Merge(other.Moves);
+		Duration.Merge(other.Duration);
+
+		for( std::size_t i = 0; i <= MaxExponent; i++ ) {
+			TileReached[i] += other.TileReached[i];
+		}
+
+	}
+
+	uint64_t GameStatistics::GetGames() const {
+		return Score.GetCount();
+	}
+
+	double GameStatistics::GetReachRate(const std::size_t exponent) const {
+		return GetGames() > 0 ? (double) TileReached[exponent] / GetGames() : 0.0;
+	}
+
+	void MergeStatistics(StatisticsTable &target, const StatisticsTable &source) {
+
+		for( const auto &[key, statistics] : source ) {
+			target[key].Merge(statistics);
+		}
+
+	}
+
+	void EncodeStatistics(const StatisticsTable &statistics, std::vector<uint8_t> &buffer) {
+
+		PutVarint(buffer, statistics.size());
+
+		for( const auto &[key, gameStatistics] : statistics ) {
+
+			PutVarint(buffer, key.first);
+			PutVarint(buffer, key.second.size());
+			buffer.insert(buffer.end(), key.second.begin(), key.second.end());
+
+			gameStatistics.Score.Encode(buffer);
+			gameStatistics.MaxTile.Encode(buffer);
+			gameStatistics.Moves.Encode(buffer);
+			gameStatistics.Duration.Encode(buffer);
+
+			for( uint64_t reached : gameStatistics.TileReached ) {
+				PutVarint(buffer, reached);
+			}
+
+		}
+
+	}
+
+	bool DecodeStatistics(const std::vector<uint8_t> &buffer, StatisticsTable &statistics) {
+
+		const uint8_t *data = buffer.data();
+		const uint8_t *end = data + buffer.size();
+
+		StatisticsTable decoded;
+		uint64_t entries;
+
+		if( !GetVarint(data, end, entries) ) return false;
+
+		for( uint64_t i = 0; i < entries; i++ ) {
+
+			uint64_t boardSize, nameLength;
+			if( !GetVarint(data, end, boardSize) || !GetVarint(data, end, nameLength) || nameLength > (uint64_t) (end - data) ) return false;
+
+			std::string policy(reinterpret_cast<const char *>(data), nameLength);
+			data += nameLength;
+
+			GameStatistics &gameStatistics = decoded[{ static_cast<int8_t>(boardSize), policy }];
+
+			if( !gameStatistics.Score.Decode(data, end) || !gameStatistics.MaxTile.Decode(data, end) ||
+				!gameStatistics.Moves.Decode(data, end) || !gameStatistics.Duration.Decode(data, end) ) return false;
+
+			for( uint64_t &reached : gameStatistics.TileReached ) {
+				if( !GetVarint(data, end, reached) ) return false;
+			}
+
+		}
+
+		if( data != end ) return false;
+
+		statistics = std::move(decoded);
+
+		return true;
+	}
+
+	namespace {
+
+		const std::vector<std::pair<std::string, const Histogram GameStatistics::*>> HistogramColumns {
+			{ "score", &GameStatistics::Score },
+			{ "max_tile", &GameStatistics::MaxTile },
+			{ "moves", &GameStatistics::Moves },
+			{ "duration_us", &GameStatistics::Duration }
+		};
+
+	}
+
+	void WriteStatisticsCsv(std::ostream &stream, const StatisticsTable &statistics) {
+
+		stream << "size,policy,metric,lower,upper,count" << std::endl;
+
+		for( const auto &[key, gameStatistics] : statistics ) {
+
+			const auto &[boardSize, policy] = key;
+
+			for( const auto &[name, histogram] : HistogramColumns ) {
+				for( std::size_t i = 0; i < Histogram::BucketCount; i++ ) {
+
+					uint64_t count = (gameStatistics.*histogram).GetBucketCount(i);
+					if( count == 0 ) continue;
+
+					stream << (int) boardSize << "," << policy << "," << name << ","
+						<< Histogram::GetBucketLowerBound(i) << "," << Histogram::GetBucketUpperBound(i) << "," << count << "\n";
+
+				}
+			}
+
+			// games which reached tile, lower and upper are the tile itself
+			for( std::size_t exponent = 1; exponent <= GameStatistics::MaxExponent; exponent++ ) {
+
+				if( gameStatistics.TileReached[exponent] == 0 ) continue;
+
+				stream << (int) boardSize << "," << policy << ",reach,"
+					<< (1u << exponent) << "," << (1u << exponent) << "," << gameStatistics.TileReached[exponent] << "\n";
+
+			}
+
+		}
+
+		stream.flush();
+
+	}
+
+	void WriteStatisticsJson(std::ostream &stream, const StatisticsTable &statistics) {
+
+		stream << "[";
+
+		bool firstKey = true;
+
+		for( const auto &[key, gameStatistics] : statistics ) {
+
+			const auto &[boardSize, policy] = key;
+
+			stream << (firstKey ? "\n" : ",\n");
+			firstKey = false;
+
+			stream << "  {\n    \"size\": " << (int) boardSize << ",\n    \"policy\": \"" << policy << "\",\n    \"games\": " << gameStatistics.GetGames();
+
+			for( const auto &[name, member] : HistogramColumns ) {
+
+				const Histogram &histogram = gameStatistics.*member;
+
+				stream << ",\n    \"" << name << "\": { \"mean\": " << histogram.GetMean()
+					<< ", \"min\": " << histogram.GetMin() << ", \"max\": " << histogram.GetMax()
+					<< ", \"p50\": " << histogram.GetPercentile(0.5) << ", \"p90\": " << histogram.GetPercentile(0.9)
+					<< ", \"p99\": " << histogram.GetPercentile(0.99) << ", \"buckets\": [";
+
+				bool firstBucket = true;
+
+				for( std::size_t i = 0; i < Histogram::BucketCount; i++ ) {
+
+					if( histogram.GetBucketCount(i) == 0 ) continue;
+
+					stream << (firstBucket ? "" : ", ") << "[" << Histogram::GetBucketLowerBound(i) << ", "
+						<< Histogram::GetBucketUpperBound(i) << ", " << histogram.GetBucketCount(i) << "]";
+					firstBucket = false;
+
+				}
+
+				stream << "] }";
+
+			}
+
+			stream << ",\n    \"reach\": {";
+
+			bool firstTile = true;
+
+			for( std::size_t exponent = 1; exponent <= GameStatistics::MaxExponent; exponent++ ) {
+
+				if( gameStatistics.TileReached[exponent] == 0 ) continue;
+
+				stream << (firstTile ? " " : ", ") << "\"" << (1u << exponent) << "\": " << gameStatistics.GetReachRate(exponent);
+				firstTile = false;
+
+			}
+
+			stream << " }\n  }";
+
+		}
+
+		stream << "\n]" << std::endl;
+
+	}
+
+}
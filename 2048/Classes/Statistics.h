@@ -0,0 +1,151 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Game2048 {
+
+	/// <summary>
+	/// Streaming histogram with constant memory, values are counted in log-linear buckets
+	/// (exact below 16, then 8 buckets per power of two, so relative error stays under 12.5 %)
+	/// </summary>
+	class Histogram {
+
+	public:
+
+		static const std::size_t BucketCount = 16 + 60 * 8;
+
+		void Add(const uint64_t value);
+
+		/// <summary>
+		/// Adds all values counted by other histogram
+		/// </summary>
+		/// <param name="other"></param>
+		void Merge(const Histogram &other);
+
+		uint64_t GetCount() const;
+		uint64_t GetMin() const;
+		uint64_t GetMax() const;
+		double GetMean() const;
+
+		/// <summary>
+		/// Estimates value below which lies given fraction of counted values
+		/// </summary>
+		/// <param name="fraction">0.0 - 1.0</param>
+		/// <returns>lower bound of bucket containing percentile</returns>
+		uint64_t GetPercentile(const double fraction) const;
+
+		uint64_t GetBucketCount(const std::size_t bucket) const;
+
+		/// <summary>
+		/// Appends compact binary form (summary and non empty buckets as varints) to buffer
+		/// </summary>
+		void Encode(std::vector<uint8_t> &buffer) const;
+
+		/// <summary>
+		/// Reads histogram of Encode and moves data to its end
+		/// </summary>
+		/// <returns>false for truncated or malformed data</returns>
+		bool Decode(const uint8_t *&data, const uint8_t *end);
+
+		/// <summary>
+		/// Smallest value counted in given bucket
+		/// </summary>
+		static uint64_t GetBucketLowerBound(const std::size_t bucket);
+
+		/// <summary>
+		/// Biggest value counted in given bucket
+		/// </summary>
+		static uint64_t GetBucketUpperBound(const std::size_t bucket);
+
+	private:
+
+		static std::size_t GetBucket(const uint64_t value);
+
+		std::array<uint64_t, BucketCount> Buckets {};
+
+		uint64_t Count = 0;
+		uint64_t Sum = 0;
+		uint64_t Min = UINT64_MAX;
+		uint64_t Max = 0;
+
+	};
+
+	/// <summary>
+	/// Result of one finished game
+	/// </summary>
+	struct GameSummary {
+		uint32_t Score = 0;
+		uint16_t MaxTile = 0;
+		uint32_t Moves = 0;
+		uint64_t DurationMicroseconds = 0;
+	};
+
+	/// <summary>
+	/// Aggregated results of many games, memory does not depend on number of games
+	/// </summary>
+	class GameStatistics {
+
+	public:
+
+		static const std::size_t MaxExponent = 16;
+
+		void Add(const GameSummary &summary);
+		void Merge(const GameStatistics &other);
+
+		uint64_t GetGames() const;
+
+		/// <summary>
+		/// Fraction of games which reached tile 2^exponent
+		/// </summary>
+		double GetReachRate(const std::size_t exponent) const;
+
+		Histogram Score;
+		Histogram MaxTile;
+		Histogram Moves;
+		Histogram Duration;
+
+		// Number of games which reached tile 2^i
+		std::array<uint64_t, MaxExponent + 1> TileReached {};
+
+	};
+
+	// Board size and policy name
+	using StatisticsKey = std::pair<int8_t, std::string>;
+
+	using StatisticsTable = std::map<StatisticsKey, GameStatistics>;
+
+	/// <summary>
+	/// Adds all statistics from source to target
+	/// </summary>
+	void MergeStatistics(StatisticsTable &target, const StatisticsTable &source);
+
+	/// <summary>
+	/// Appends binary form of whole table to buffer, used by simulation shards
+	/// </summary>
+	void EncodeStatistics(const StatisticsTable &statistics, std::vector<uint8_t> &buffer);
+
+	/// <summary>
+	/// Reads table of EncodeStatistics, all data has to be consumed
+	/// </summary>
+	/// <returns>false for truncated or malformed data</returns>
+	bool DecodeStatistics(const std::vector<uint8_t> &buffer, StatisticsTable &statistics);
+
+	/// <summary>
+	/// Writes every non empty histogram bucket and reach count as one CSV line
+	/// </summary>
+	void WriteStatisticsCsv(std::ostream &stream, const StatisticsTable &statistics);
+
+	/// <summary>
+	/// Writes summary, histograms and reach rates of every board size and policy as JSON
+	/// </summary>
+	void WriteStatisticsJson(std::ostream &stream, const StatisticsTable &statistics);
+
+}
@@ -0,0 +1,199 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#include "Tournament.h"
+#include "Simulation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+namespace Game2048 {
+
+	// z value of two sided 95% interval
+	const double ConfidenceZ = 1.96;
+
+	Interval GetInterval(const std::vector<double> &values) {
+
+		Interval interval;
+		if( values.empty() ) return interval;
+
+		double sum = 0;
+		for( double value : values ) {
+			sum += value;
+		}
+
+		interval.Mean = sum / values.size();
+
+		double squares = 0;
+		for( double value : values ) {
+			squares += (value - interval.Mean) * (value - interval.Mean);
+		}
+
+		// sample deviation, single value has no spread
+		double deviation = values.size() > 1 ? std::sqrt(squares / (values.size() - 1)) : 0;
+		double margin = ConfidenceZ * deviation / std::sqrt(values.size());
+
+		interval.Low = interval.Mean - margin;
+		interval.High = interval.Mean + margin;
+
+		return interval;
+	}
+
+	TournamentReport RunTournament(const TournamentConfig &config) {
+
+		auto start = std::chrono::steady_clock::now();
+
+		TournamentReport report;
+		report.BoardSize = config.BoardSize;
+
+		for( const std::string &policy : config.Policies ) {
+
+			PolicyResult result;
+			result.Policy = policy;
+			result.Games.resize(config.Games);
+
+			report.Results.push_back(result);
+
+		}
+
+		// policies of one seed are neighbours, so slow policy does not end up on one thread
+		uint64_t totalGames = config.Games * config.Policies.size();
+		std::atomic<uint64_t> nextGame = 0;
+
+		std::vector<std::thread> threads;
+
+		for( unsigned t = 0; t < std::max(1u, config.Threads); t++ ) {
+
+			threads.emplace_back([&]() {
+
+				uint64_t i;
+				while( (i = nextGame.fetch_add(1)) < totalGames ) {
+
+					uint64_t game = i / config.Policies.size();
+					std::size_t policyIndex = i % config.Policies.size();
+
+					uint64_t seed = config.Seed + game;
+					auto policy = CreatePolicy(config.Policies[policyIndex], GetPolicySeed(seed));
+
+					Game tournamentGame(config.BoardSize, seed);
+					tournamentGame.StartGame();
+
+					// every slot is written by one thread only
+					report.Results[policyIndex].Games[game] = SimulateGame(tournamentGame, *policy);
+
+				}
+
+			});
+
+		}
+
+		for( std::thread &thread : threads ) {
+			thread.join();
+		}
+
+		for( PolicyResult &result : report.Results ) {
+
+			std::vector<double> scores, maxTiles;
+			uint64_t wins = 0;
+
+			for( const GameSummary &summary : result.Games ) {
+
+				scores.push_back(summary.Score);
+				maxTiles.push_back(summary.MaxTile);
+
+				if( summary.MaxTile >= 2048 ) wins++;
+
+			}
+
+			result.Score = GetInterval(scores);
+			result.MaxTile = GetInterval(maxTiles);
+			result.WinRate = result.Games.empty() ? 0 : static_cast<double>(wins) / result.Games.size();
+
+		}
+
+		for( std::size_t first = 0; first < report.Results.size(); first++ ) {
+			for( std::size_t second = first + 1; second < report.Results.size(); second++ ) {
+
+				PairedComparison comparison;
+				comparison.First = first;
+				comparison.Second = second;
+
+				std::vector<double> differences;
+				uint64_t wins = 0, ties = 0;
+
+				for( uint64_t game = 0; game < config.Games; game++ ) {
+
+					double difference = static_cast<double>(report.Results[first].Games[game].Score) - report.Results[second].Games[game].Score;
+					differences.push_back(difference);
+
+					if( difference > 0 ) wins++;
+					if( difference == 0 ) ties++;
+
+				}
+
+				comparison.ScoreDifference = GetInterval(differences);
+				comparison.Wins = config.Games ? static_cast<double>(wins) / config.Games : 0;
+				comparison.Ties = config.Games ? static_cast<double>(ties) / config.Games : 0;
+
+				report.Comparisons.push_back(comparison);
+
+			}
+		}
+
+		report.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return report;
+	}
+
+	void WriteTournamentReport(std::ostream &stream, const TournamentReport &report) {
+
+		char line[256];
+
+		uint64_t games = report.Results.empty() ? 0 : report.Results.front().Games.size();
+
+		snprintf(line, sizeof(line), "Board %dx%d, %llu seeds per policy, %.2f s\n\n", report.BoardSize, report.BoardSize,
+			(unsigned long long) games, report.Seconds);
+		stream << line;
+
+		snprintf(line, sizeof(line), "%-16s %12s %25s %10s %8s %10s\n", "policy", "mean score", "95% interval", "max tile", "2048", "ms/game");
+		stream << line;
+
+		for( const PolicyResult &result : report.Results ) {
+
+			double microseconds = 0;
+			for( const GameSummary &summary : result.Games ) {
+				microseconds += summary.DurationMicroseconds;
+			}
+
+			snprintf(line, sizeof(line), "%-16s %12.1f   [%10.1f, %10.1f] %10.1f %7.1f%% %10.2f\n", result.Policy.c_str(), result.Score.Mean,
+				result.Score.Low, result.Score.High, result.MaxTile.Mean, result.WinRate * 100,
+				result.Games.empty() ? 0 : microseconds / 1000 / result.Games.size());
+			stream << line;
+
+		}
+
+		if( !report.Comparisons.empty() ) {
+			stream << "\nPaired score differences on identical seeds:\n";
+		}
+
+		for( const PairedComparison &comparison : report.Comparisons ) {
+
+			const Interval &difference = comparison.ScoreDifference;
+
+			// interval not containing zero is significant on 5% level
+			bool significant = difference.Low > 0 || difference.High < 0;
+
+			std::string pair = report.Results[comparison.First].Policy + " - " + report.Results[comparison.Second].Policy;
+
+			snprintf(line, sizeof(line), "%-34s %+12.1f   [%+10.1f, %+10.1f]  wins %5.1f%%  ties %5.1f%%%s\n", pair.c_str(), difference.Mean,
+				difference.Low, difference.High, comparison.Wins * 100, comparison.Ties * 100, significant ? "  *" : "");
+			stream << line;
+
+		}
+
+	}
+
+}
@@ -0,0 +1,102 @@
+﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Statistics.h"
+
+namespace Game2048 {
+
+	/// <summary>
+	/// Policies playing the same seeds against each other
+	/// </summary>
+	struct TournamentConfig {
+
+		int8_t BoardSize = 4;
+		std::vector<std::string> Policies { "random", "greedy" };
+
+		// Seeds played by every policy
+		uint64_t Games = 100;
+
+		unsigned Threads = 1;
+
+		// Game i is seeded by Seed + i for every policy
+		uint64_t Seed = 0;
+
+	};
+
+	/// <summary>
+	/// Mean with 95% confidence interval of normal approximation
+	/// </summary>
+	struct Interval {
+
+		double Mean = 0;
+		double Low = 0;
+		double High = 0;
+
+	};
+
+	struct PolicyResult {
+
+		std::string Policy;
+
+		// Game i was played with seed Seed + i
+		std::vector<GameSummary> Games;
+
+		Interval Score;
+		Interval MaxTile;
+
+		// Share of games which reached 2048
+		double WinRate = 0;
+
+	};
+
+	/// <summary>
+	/// Difference of two policies on the same seeds, pairing removes luck of spawns from comparison
+	/// </summary>
+	struct PairedComparison {
+
+		std::size_t First = 0;
+		std::size_t Second = 0;
+
+		// Score of first minus score of second
+		Interval ScoreDifference;
+
+		// Shares of seeds where first scored more and equal
+		double Wins = 0;
+		double Ties = 0;
+
+	};
+
+	struct TournamentReport {
+
+		int8_t BoardSize = 0;
+		std::vector<PolicyResult> Results;
+		std::vector<PairedComparison> Comparisons;
+
+		double Seconds = 0;
+
+	};
+
+	/// <summary>
+	/// Mean of values with 95% confidence interval
+	/// </summary>
+	Interval GetInterval(const std::vector<double> &values);
+
+	/// <summary>
+	/// Plays every policy on every seed across threads and compares every pair of policies
+	/// </summary>
+	/// <param name="config"></param>
+	/// <returns></returns>
+	TournamentReport RunTournament(const TournamentConfig &config);
+
+	/// <summary>
+	/// Writes table of policies and their paired comparisons as text
+	/// </summary>
+	void WriteTournamentReport(std::ostream &stream, const TournamentReport &report);
+
+}
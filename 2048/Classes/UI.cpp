@@ -1,8 +1,21 @@
 ﻿// Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)
 
 #include "UI.h"
+#include "Analysis.h"
+#include "Evaluator.h"
 #include "HighScore.h"
+#include "LiveFeed.h"
 #include "Game.h"
+#include "Search.h"
+#include "EventLoop.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <ctime>
+#include <future>
+#include <thread>
 
 #include <ncurses.h>
 
@@ -10,6 +23,12 @@ namespace Game2048 {
 
 	void UIInit() {
 
+		// SIGWINCH has to be blocked before ncurses and any thread starts
+		GetEventLoop();
+
+		// weights are loaded now, warning about invalid file would be drawn over screen of ncurses
+		GetDefaultEvaluator();
+
 		initscr();
 		keypad(stdscr, true);
 		cbreak();
@@ -19,7 +38,12 @@ namespace Game2048 {
 	}
 
 	void UIDeInit() {
+
+		// scores of last games may still wait for writer thread
+		FlushLeaderboard();
+
 		endwin();
+
 	}
 
 	void InitColors() {
@@ -28,156 +52,383 @@ namespace Game2048 {
 
 			start_color();
 
-			init_pair(1, COLOR_BLACK, COLOR_RED);
-			init_pair(2, COLOR_BLACK, COLOR_GREEN);
-			init_pair(3, COLOR_BLACK, COLOR_YELLOW);
-			init_pair(4, COLOR_BLACK, COLOR_BLUE);
-			init_pair(5, COLOR_BLACK, COLOR_MAGENTA);
-			init_pair(6, COLOR_BLACK, COLOR_CYAN);
-			init_pair(7, COLOR_BLACK, COLOR_WHITE);
-			init_pair(8, COLOR_RED, COLOR_BLACK);
-			init_pair(9, COLOR_RED, COLOR_GREEN);
-			init_pair(10, COLOR_RED, COLOR_YELLOW);
-			init_pair(11, COLOR_RED, COLOR_BLUE);
-			init_pair(12, COLOR_RED, COLOR_MAGENTA);
-			init_pair(13, COLOR_RED, COLOR_CYAN);
-			init_pair(14, COLOR_RED, COLOR_WHITE);
-
-			init_pair(30, COLOR_GREEN, COLOR_BLACK);
+			for( const ColorPair &colorPair : ColorPairs ) {
+				init_pair(colorPair.Pair, colorPair.Foreground, colorPair.Background);
+			}
 
 		}
 
 	}
 
-	void PlayGame() {
+	int RunInteractive(const bool seeded, const uint64_t seed) {
 
-		int8_t boardSize = Game2048::BoardSizes();
-		if( boardSize <= 0 ) return;
+		UIInit();
 
-		Game2048::ClearScreen();
+		// seeded game of menu offers last typed seed again
+		uint64_t menuSeed = seed;
 
-		int rows, cols;
-		getmaxyx(stdscr, rows, cols);
+		bool loop = true;
 
-		rows -= 2;
+		while( loop ) {
 
-		int rowCenter = rows / 2;
-		int colCenter = cols / 2;
+			MenuOption menuOption = Menu();
 
-		int windowHeight = Game2048::TileHeight * (boardSize + 1);
-		int windowWidth = Game2048::TileWidth * boardSize + 6;
+			switch( menuOption ) {
 
-		int rowStart = rowCenter - windowHeight / 2;
-		int colStart = colCenter - boardSize * 10 / 2 - 15;
+				case NEW_GAME:
+					PlayGame(seeded, seed);
+					break;
+				case SEEDED_GAME:
+					if( AskSeed(menuSeed) ) PlayGame(true, menuSeed);
+					break;
+				case HIGH_SCORE:
+					PrintHighScore();
+					break;
+				case QUIT:
+					loop = false;
+					break;
+				default:
+					break;
+			}
 
-		// create window for tiles
-		WINDOW *gameWindow = newwin(windowHeight, windowWidth, rowStart, colStart);
-		box(gameWindow, ACS_BULLET, ACS_BULLET);
+		}
+
+		UIDeInit();
+
+		return EXIT_SUCCESS;
+	}
+
+	void PlayGame(const bool seeded, const uint64_t seed) {
+
+		int8_t boardSize = Game2048::BoardSizes();
+		if( boardSize <= 0 ) return;
 
-		// create high score window
-		WINDOW *highScoreWindow = newwin(windowHeight, 22, rowStart, colStart + windowWidth + 5);
-		box(highScoreWindow, ACS_VLINE, ACS_HLINE);
+		Game2048::EventLoop &eventLoop = Game2048::GetEventLoop();
 
-		refresh();
-		wrefresh(gameWindow);
-		wrefresh(highScoreWindow);
+		Game2048::NcursesRenderer renderer;
 
-		std::vector<uint32_t> highScores = Game2048::GetHighScoresFromFile();
+		Game2048::Leaderboard &leaderboard = Game2048::GetLeaderboard();
+		std::vector<Game2048::ScoreRecord> highScores = leaderboard.GetTop(boardSize, Game2048::PERIOD_ALL_TIME, time(nullptr));
+
+		// unseeded games still get seed from global rand(), so they can be played again
+		auto nextSeed = [seeded, seed]() {
+			return seeded ? seed : static_cast<uint64_t>(rand());
+		};
 
 		// create game class
-		Game2048::Game game(boardSize);
+		uint64_t gameSeed = nextSeed();
+		Game2048::Game game(boardSize, gameSeed);
 		game.StartGame();
 
-		Game2048::PrintGame(gameWindow, highScoreWindow, &game, &highScores);
+		// observers get every position, new game starts with move 0
+		Game2048::LiveFeed &feed = Game2048::GetLiveFeed();
+		feed.Publish(game, 0);
+
+		uint32_t moves = 0;
+		auto gameStart = std::chrono::steady_clock::now();
+
+		Game2048::SearchConfig hintConfig;
+		hintConfig.TimeBudget = std::chrono::milliseconds(HintTimeBudgetMs);
+		hintConfig.UseOpeningBook = true;
+		hintConfig.UseCache = true;
+
+		Game2048::ExpectimaxSearch hintSearch(Game2048::GetDefaultEvaluator(), hintConfig);
+
+		// hint is searched in background, result belongs to position with this hash,
+		// ready is set right before search posts redraw
+		std::future<Game2048::Direction> hint;
+		std::atomic<bool> hintReady = false;
+		uint64_t hintHash = 0;
+
+		// repeating timer of autoplay, -1 when player moves alone
+		int autoplayTimer = -1;
+
+		// finished game is analyzed in background, ready is set right before analysis posts redraw
+		Game2048::GameRecord record;
+		std::future<Game2048::RegretReport> analysis;
+		std::atomic<bool> analysisReady = false;
+		std::atomic<bool> analysisCancel = false;
+
+		Game2048::GameFrame frame;
+		frame.CurrentGame = &game;
+		frame.HighScores = &highScores;
+		frame.Seed = "Seed: " + std::to_string(gameSeed);
+
+		// computes layout from actual terminal size, called again after resize
+		auto layout = [&]() {
+
+			int rows, cols;
+			getmaxyx(stdscr, rows, cols);
+
+			renderer.Resize(rows, cols);
+			renderer.DrawGame(frame);
+
+		};
+
+		auto saveScore = [&]() {
+
+			if( game.GetScore() == 0 ) return;
+
+			Game2048::ScoreRecord record;
+			record.BoardSize = boardSize;
+			record.Score = game.GetScore();
+			record.MaxTile = game.GetMaxTile();
+			record.Moves = moves;
+			record.DurationSeconds = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - gameStart).count();
+			record.Timestamp = time(nullptr);
+
+			leaderboard.Add(record);
+			highScores = leaderboard.GetTop(boardSize, Game2048::PERIOD_ALL_TIME, record.Timestamp);
+
+		};
+
+		auto startAnalysis = [&]() {
+
+			record.Positions.push_back(game.GetPosition());
+
+			frame.Analysis = { AnalyzingLabel };
+
+			Game2048::RegretConfig config;
+			config.Rollouts = AnalysisRollouts;
+			config.Threads = std::max(1u, std::thread::hardware_concurrency());
+
+			analysis = std::async(std::launch::async, [&eventLoop, &analysisReady, &analysisCancel, config, finished = record]() {
+
+				// file write does not delay drawing of game over screen
+				Game2048::SaveGameRecord(Game2048::LastGameFile, finished);
+
+				Game2048::RegretReport report = Game2048::AnalyzeGame(finished, config, &analysisCancel);
+
+				analysisReady = true;
+				eventLoop.PostRedraw();
+
+				return report;
+			});
+
+		};
+
+		auto stopAnalysis = [&]() {
+
+			if( analysis.valid() ) {
+
+				analysisCancel = true;
+				analysis.wait();
+
+				analysis = {};
+				analysisCancel = false;
+				analysisReady = false;
+
+			}
+
+			record = {};
+			frame.Analysis.clear();
+
+		};
+
+		auto startHint = [&]() {
+
+			// one search at time, keys are handled meanwhile
+			if( hint.valid() || game.GetLegalMoves() == 0 ) return;
+
+			hintHash = game.GetHash();
+			hint = std::async(std::launch::async, [&hintSearch, &eventLoop, &hintReady, position = game]() {
+
+				Game2048::Direction move = hintSearch.Search(position).Move;
+
+				hintReady = true;
+				eventLoop.PostRedraw();
+
+				return move;
+			});
+
+		};
+
+		auto stopAutoplay = [&]() {
+
+			if( autoplayTimer < 0 ) return;
+
+			eventLoop.RemoveTimer(autoplayTimer);
+			autoplayTimer = -1;
+			frame.Hint.clear();
+
+		};
+
+		auto playMove = [&](const Game2048::Direction direction) {
+
+			if( !(game.GetLegalMoves() & Game2048::DirectionMask(direction)) ) return;
+
+			record.Positions.push_back(game.GetPosition());
+			record.Moves.push_back(direction);
+
+			game.MoveBoard(direction);
+			game.AddRandomTile();
+			moves++;
+			feed.Publish(game, moves);
+
+			// hint belongs to previous position
+			frame.GameOver = game.GetLegalMoves() == 0;
+			frame.Hint.clear();
+
+			if( frame.GameOver ) {
+				stopAutoplay();
+				startAnalysis();
+			} else if( autoplayTimer >= 0 ) {
+				frame.Hint = AutoplayLabel;
+			}
+
+			renderer.DrawGame(frame);
+
+		};
+
+		auto restart = [&]() {
+
+			saveScore();
+			stopAutoplay();
+			stopAnalysis();
+
+			// restarts game, seeded game starts the same again
+			gameSeed = nextSeed();
+			game.Seed(gameSeed);
+			game.StartGame();
+			moves = 0;
+			feed.Publish(game, moves);
+			gameStart = std::chrono::steady_clock::now();
+			frame.GameOver = false;
+			frame.Hint.clear();
+			frame.Seed = "Seed: " + std::to_string(gameSeed);
+
+			renderer.DrawGame(frame);
+
+		};
+
+		layout();
 
 		bool loop = true;
 
 		// game loop
 		while( loop ) {
 
-			int input = getch();
+			Game2048::Event event = eventLoop.WaitEvent(stdscr);
 
-			switch( input ) {
-				case Game2048::UP:
-				case Game2048::RIGHT:
-				case Game2048::DOWN:
-				case Game2048::LEFT:
+			if( event.Type == Game2048::EVENT_RESIZE ) {
+				layout();
+				continue;
+			}
 
-					if( game.IsMovePossible(static_cast<Game2048::Direction>(input)) ) {
+			if( event.Type == Game2048::EVENT_REDRAW ) {
 
-						game.MoveBoard(static_cast<Game2048::Direction>(input));
-						game.AddRandomTile();
+				// analysis posts redraws too, get is called only after search finished and waits just for its return
+				if( hintReady.exchange(false) ) {
 
-						loop = game.IsMovePossible();
+					Game2048::Direction move = hint.get();
 
-						Game2048::PrintGame(gameWindow, highScoreWindow, &game, &highScores);
+					// position could change while hint was searched
+					if( !frame.GameOver && game.GetHash() == hintHash ) {
 
-						if( !loop ) {
-							Game2048::PrintGameOver();
-							input = getch();
+						if( autoplayTimer >= 0 ) {
+							playMove(move);
+						} else {
+							frame.Hint = "Hint: " + Game2048::GetDirectionArrow(move);
+							renderer.DrawGame(frame);
+						}
 
-							if( input == 'r' ) {
+					}
 
-								loop = true;
+				}
 
-								if( game.GetScore() > 0 ) {
-									highScores.push_back(game.GetScore());
-								}
+				if( analysisReady.exchange(false) ) {
 
-								Game2048::WriteHighScoreToFile(highScores);
-								wclear(gameWindow);
-								wclear(highScoreWindow);
-								box(gameWindow, ACS_BULLET, ACS_BULLET);
-								box(highScoreWindow, ACS_VLINE, ACS_HLINE);
+					Game2048::RegretReport report = analysis.get();
+					std::vector<Game2048::MoveRegret> blunders = Game2048::GetBlunders(report, BlunderCount);
 
-								// restarts game
-								game.StartGame();
+					frame.Analysis = { blunders.empty() ? NoBlundersLabel : BlundersLabel };
 
-								Game2048::PrintGame(gameWindow, highScoreWindow, &game, &highScores);
+					// move number, played and best move, lost expected score
+					for( const Game2048::MoveRegret &blunder : blunders ) {
 
-							}
+						char line[64];
+						snprintf(line, sizeof(line), "%4zu %s %s %6.0f", blunder.Index + 1, GetDirectionArrow(blunder.Played).c_str(),
+							GetDirectionArrow(blunder.Best).c_str(), -blunder.Regret);
 
-						}
+						frame.Analysis.push_back(line);
 
 					}
 
-					break;
+					renderer.DrawGame(frame);
 
-				case 'q':
+				}
+
+				continue;
+			}
+
+			// tick waits for running search, so slow search does not pile up moves
+			if( event.Type == Game2048::EVENT_TIMER ) {
+				if( event.Timer == autoplayTimer ) startHint();
+				continue;
+			}
+
+			if( event.Type != Game2048::EVENT_KEY ) continue;
+
+			// after game over only restart is possible, other keys leave game
+			if( frame.GameOver ) {
+
+				if( event.Key == 'r' ) {
+					restart();
+				} else {
 					loop = false;
+				}
+
+				continue;
+			}
+
+			switch( event.Key ) {
+				case Game2048::UP:
+				case Game2048::RIGHT:
+				case Game2048::DOWN:
+				case Game2048::LEFT:
+					playMove(static_cast<Game2048::Direction>(event.Key));
 					break;
 
-				case 'r':
+				case 'h':
+					startHint();
+					break;
 
-					if( game.GetScore() > 0 ) {
-						highScores.push_back(game.GetScore());
-					}
+				case 'a':
 
-					Game2048::WriteHighScoreToFile(highScores);
-					wclear(gameWindow);
-					wclear(highScoreWindow);
-					box(gameWindow, ACS_BULLET, ACS_BULLET);
-					box(highScoreWindow, ACS_VLINE, ACS_HLINE);
+					// pressed again gives moves back to player
+					if( autoplayTimer >= 0 ) {
+						stopAutoplay();
+					} else {
+						autoplayTimer = eventLoop.AddTimer(std::chrono::milliseconds(AutoplayIntervalMs), true);
+						if( autoplayTimer >= 0 ) frame.Hint = AutoplayLabel;
+					}
 
-					// restarts game
-					game.StartGame();
+					renderer.DrawGame(frame);
+					break;
 
-					Game2048::PrintGame(gameWindow, highScoreWindow, &game, &highScores);
+				case 'q':
+					loop = false;
+					break;
 
+				case 'r':
+					restart();
 					break;
 
 			}
 
 		}
 
-		if( game.GetScore() > 0 ) {
-			highScores.push_back(game.GetScore());
+		// timer of event loop would outlive game
+		stopAutoplay();
+
+		// running search must end before game is destroyed
+		if( hint.valid() ) {
+			hint.wait();
 		}
 
-		Game2048::WriteHighScoreToFile(highScores);
+		stopAnalysis();
 
-		delwin(gameWindow);
-		delwin(highScoreWindow);
+		saveScore();
 
 	}
 
@@ -201,6 +452,18 @@ namespace Game2048 {
 
 	}
 
+	std::string GetDirectionArrow(const Direction direction) {
+
+		switch( direction ) {
+			case Direction::UP: return "↑";
+			case Direction::RIGHT: return "→";
+			case Direction::DOWN: return "↓";
+			case Direction::LEFT: return "←";
+			default: return "";
+		}
+
+	}
+
 	void PrintGameOver() {
 
 		int cols = getmaxx(stdscr);
@@ -253,87 +516,90 @@ namespace Game2048 {
 
 	void PrintHighScore() {
 
-		ClearScreen();
+		EventLoop &eventLoop = GetEventLoop();
 
-		int cols, rows;
-		getmaxyx(stdscr, rows, cols);
+		NcursesRenderer renderer;
 
-		rows -= 2;
+		HighScoreFrame frame;
 
-		int colCenter = cols / 2;
-		int rowCenter = rows / 2;
+		// computes layout from actual terminal size, called again after resize
+		auto layout = [&]() {
 
-		int windowHeight = colCenter + colCenter / 2;
-		int windowWidth = rowCenter + rowCenter / 2;
+			int rows, cols;
+			getmaxyx(stdscr, rows, cols);
 
-		WINDOW *highScoreWin = newwin(windowWidth, windowHeight, rowCenter - (windowWidth / 2), colCenter - (windowHeight / 2));
-		box(highScoreWin, ACS_BULLET, 0);
+			renderer.Resize(rows, cols);
 
-		refresh();
-		wrefresh(highScoreWin);
+		};
 
-		keypad(highScoreWin, true);
+		layout();
 
-		auto highScores = GetHighScoresFromFile();
+		Leaderboard &leaderboard = GetLeaderboard();
 
-		int8_t selectedItem = 0;
+		int8_t boardSize = MinBoardSize + 1;
+		LeaderboardPeriod period = PERIOD_ALL_TIME;
 
-		while( true ) {
+		std::vector<ScoreRecord> highScores;
+		frame.HighScores = &highScores;
 
-			// print high score
-			wattron(highScoreWin, COLOR_PAIR(30));
-			mvwprintw(highScoreWin, 2, (windowHeight / 2) - HighScoreHeader.size() / 2, "%s", HighScoreHeader.c_str());
-			wattroff(highScoreWin, COLOR_PAIR(30));
-
-			for( int8_t i = 0, len = highScores.size(); i < len; i++ ) {
-				mvwprintw(highScoreWin, i + 4, (windowHeight / 2) - 6, "%2d.) %7d", i + 1, highScores.at(i));
-			}
+		while( true ) {
 
-			int startingRow = highScores.size() + 6;
+			highScores = leaderboard.GetTop(boardSize, period, time(nullptr));
+			frame.Title = SizeOptions.at(boardSize - MinBoardSize) + ", " + PeriodNames.at(period) + "  (←, → size, p period)";
 
-			// print choosable items
-			for( std::size_t i = 0, len = HighScoreMenuOptions.size(); i < len; i++ ) {
+			renderer.DrawHighScore(frame);
 
-				if( selectedItem == i ) wattron(highScoreWin, A_REVERSE); // higlight selected item
-				mvwprintw(highScoreWin, startingRow + i, (windowHeight / 2) - HighScoreMenuOptions.at(i).size() / 2, "%s", HighScoreMenuOptions.at(i).c_str());
-				if( selectedItem == i ) wattroff(highScoreWin, A_REVERSE);
+			Event event = eventLoop.WaitEvent(stdscr);
 
+			if( event.Type == EVENT_RESIZE ) {
+				layout();
+				continue;
 			}
 
-			int menuInput = wgetch(highScoreWin);
+			if( event.Type != EVENT_KEY ) continue;
 
-			switch( menuInput ) {
+			switch( event.Key ) {
 
 				case KEY_UP:
-					selectedItem--;
+					frame.SelectedItem--;
 
-					if( selectedItem < 0 ) {
-						selectedItem = 0;
+					if( frame.SelectedItem < 0 ) {
+						frame.SelectedItem = 0;
 					}
 
 					break;
 
 				case KEY_DOWN:
-					selectedItem++;
+					frame.SelectedItem++;
 
-					if( selectedItem >= HighScoreMenuOptions.size() ) {
-						selectedItem = HighScoreMenuOptions.size() - 1;
+					if( frame.SelectedItem >= HighScoreMenuOptions.size() ) {
+						frame.SelectedItem = HighScoreMenuOptions.size() - 1;
 					}
 
 					break;
 
+				case KEY_LEFT:
+					boardSize = std::max<int8_t>(boardSize - 1, MinBoardSize);
+					break;
+
+				case KEY_RIGHT:
+					boardSize = std::min<int8_t>(boardSize + 1, MaxBoardSize);
+					break;
+
+				case 'p':
+					period = static_cast<LeaderboardPeriod>((period + 1) % PeriodNames.size());
+					break;
+
 				case 10: // ENTER
 
-					if( selectedItem == 0 ) {
-						WriteHighScoreToFile({});
+					if( frame.SelectedItem == 0 ) {
+						leaderboard.Clear();
 					}
 
-					delwin(highScoreWin);
 					return;
 
 				case 'q':
 
-					delwin(highScoreWin);
 					return;
 
 				default:
@@ -344,47 +610,6 @@ namespace Game2048 {
 
 	}
 
-	void PrintGame(WINDOW *gameWindow, WINDOW *highScoreWindow, Game *game, std::vector<uint32_t> *highScores) {
-
-		int rowStart = 3;
-		int colStart = 3;
-
-		wattron(gameWindow, COLOR_PAIR(30));
-		mvwprintw(gameWindow, rowStart - 1, colStart, "Score: %d", game->GetScore());
-		wattroff(gameWindow, COLOR_PAIR(30));
-
-		// print every tile of board
-		for( int8_t i = 0; i < game->GetBoardSize(); i++ ) {
-			for( int8_t j = 0; j < game->GetBoardSize(); j++ ) {
-
-				// calculate position of tile
-				uint8_t row = rowStart + i * 5;
-				uint8_t col = colStart + j * 10;
-
-				Game2048::PrintTile(gameWindow, row, col, game->GetBoard()[i][j]);
-
-			}	
-		}
-
-		wattron(highScoreWindow, COLOR_PAIR(30));
-		mvwprintw(highScoreWindow, rowStart - 1, colStart, "%s", HighScoreHeader.c_str());
-		wattroff(highScoreWindow, COLOR_PAIR(30));
-
-
-		// sort high score just in case
-		std::sort(highScores->begin(), highScores->end(), std::greater<>());
-
-		// print high score
-		for( std::size_t i = 0, len = highScores->size(); i < len && i < 10; i++ ) {
-			mvwprintw(highScoreWindow, rowStart, colStart, "%2d.) %7d", i + 1, highScores->at(i));
-			rowStart++;
-		}
-
-		wrefresh(gameWindow);
-		wrefresh(highScoreWindow);
-
-	}
-
 	void PrintLogo() {
 
 		int cols, rows;
@@ -415,18 +640,37 @@ namespace Game2048 {
 
 	int8_t BoardSizes() {
 
-		int cols, rows;
-		getmaxyx(stdscr, rows, cols);
+		EventLoop &eventLoop = GetEventLoop();
 
-		rows -= 2;
+		WINDOW *menuWin = nullptr;
+
+		// computes layout from actual terminal size, called again after resize
+		auto layout = [&](const bool redrawScreen) {
+
+			if( menuWin ) delwin(menuWin);
+
+			// sizes are chosen above logo of main menu
+			if( redrawScreen ) {
+				ClearScreen();
+				PrintLogo();
+			}
+
+			int cols, rows;
+			getmaxyx(stdscr, rows, cols);
+
+			rows -= 2;
 
-		WINDOW *menuWin = newwin(7, cols - 19, rows - 12, 9);
-		box(menuWin, ACS_BULLET, 0);
+			menuWin = newwin(7, cols - 19, rows - 12, 9);
+			box(menuWin, ACS_BULLET, 0);
 
-		refresh();
-		wrefresh(menuWin);
+			refresh();
+			wrefresh(menuWin);
 
-		keypad(menuWin, true);
+			keypad(menuWin, true);
+
+		};
+
+		layout(false);
 
 		int8_t selectedItem = 0;
 
@@ -441,9 +685,18 @@ namespace Game2048 {
 
 			}
 
-			int menuInput = wgetch(menuWin);
+			wrefresh(menuWin);
 
-			switch( menuInput ) {
+			Event event = eventLoop.WaitEvent(menuWin);
+
+			if( event.Type == EVENT_RESIZE ) {
+				layout(true);
+				continue;
+			}
+
+			if( event.Type != EVENT_KEY ) continue;
+
+			switch( event.Key ) {
 
 				case KEY_UP:
 					selectedItem--;
@@ -466,7 +719,7 @@ namespace Game2048 {
 				case 10: // ENTER
 
 					delwin(menuWin);
-					return selectedItem + 3;
+					return selectedItem + MinBoardSize;
 
 				case 'q':
 
@@ -481,23 +734,126 @@ namespace Game2048 {
 
 	}
 
+	bool AskSeed(uint64_t &seed) {
+
+		EventLoop &eventLoop = GetEventLoop();
+
+		WINDOW *menuWin = nullptr;
+
+		// the same place as board sizes, above logo of main menu
+		auto layout = [&](const bool redrawScreen) {
+
+			if( menuWin ) delwin(menuWin);
+
+			if( redrawScreen ) {
+				ClearScreen();
+				PrintLogo();
+			}
+
+			int cols, rows;
+			getmaxyx(stdscr, rows, cols);
+
+			rows -= 2;
+
+			menuWin = newwin(7, cols - 19, rows - 12, 9);
+			box(menuWin, ACS_BULLET, 0);
+
+			refresh();
+			wrefresh(menuWin);
+
+			keypad(menuWin, true);
+
+		};
+
+		layout(false);
+
+		std::string digits = std::to_string(seed);
+
+		while( true ) {
+
+			mvwprintw(menuWin, 2, 4, "%s", SeedPrompt.c_str());
+
+			// padding erases removed digit
+			wattron(menuWin, A_REVERSE);
+			mvwprintw(menuWin, 4, 4, "%-*s", (int) MaxSeedDigits, digits.c_str());
+			wattroff(menuWin, A_REVERSE);
+
+			wrefresh(menuWin);
+
+			Event event = eventLoop.WaitEvent(menuWin);
+
+			if( event.Type == EVENT_RESIZE ) {
+				layout(true);
+				continue;
+			}
+
+			if( event.Type != EVENT_KEY ) continue;
+
+			switch( event.Key ) {
+
+				case KEY_BACKSPACE:
+				case 127:
+				case 8:
+
+					if( !digits.empty() ) digits.pop_back();
+					break;
+
+				case 10: // ENTER
+
+					if( digits.empty() ) break;
+
+					delwin(menuWin);
+					seed = std::stoull(digits);
+					return true;
+
+				case 'q':
+
+					delwin(menuWin);
+					return false;
+
+				default:
+
+					if( event.Key >= '0' && event.Key <= '9' && digits.size() < MaxSeedDigits ) {
+						digits.push_back(event.Key);
+					}
+
+					break;
+			}
+
+		}
+
+	}
+
 	MenuOption Menu() {
 
-		ClearScreen();
-		PrintLogo();
-		
-		int cols, rows;
-		getmaxyx(stdscr, rows, cols);
+		EventLoop &eventLoop = GetEventLoop();
 
-		rows -= 2;
+		WINDOW *menuWin = nullptr;
+
+		// computes layout from actual terminal size, called again after resize
+		auto layout = [&]() {
+
+			if( menuWin ) delwin(menuWin);
+
+			ClearScreen();
+			PrintLogo();
+
+			int cols, rows;
+			getmaxyx(stdscr, rows, cols);
 
-		WINDOW *menuWin = newwin(7, cols - 19, rows - 12, 9);
-		box(menuWin, ACS_BULLET, 0);
+			rows -= 2;
 
-		refresh();
-		wrefresh(menuWin);
+			menuWin = newwin(7, cols - 19, rows - 12, 9);
+			box(menuWin, ACS_BULLET, 0);
 
-		keypad(menuWin, true);
+			refresh();
+			wrefresh(menuWin);
+
+			keypad(menuWin, true);
+
+		};
+
+		layout();
 
 		int8_t selectedItem = 0;
 
@@ -512,10 +868,19 @@ namespace Game2048 {
 
 			}
 
-			int menuInput = wgetch(menuWin);
+			wrefresh(menuWin);
+
+			Event event = eventLoop.WaitEvent(menuWin);
+
+			if( event.Type == EVENT_RESIZE ) {
+				layout();
+				continue;
+			}
+
+			if( event.Type != EVENT_KEY ) continue;
 
 			// handling user input in menu
-			switch( menuInput ) {
+			switch( event.Key ) {
 
 				case KEY_UP:
 					selectedItem--;
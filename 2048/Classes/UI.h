@@ -6,24 +6,75 @@
 #include <string>
 #include <vector>
 
+#include <ncurses.h>
+
 #include "Game.h"
 
 namespace Game2048 {
 
 	enum MenuOption {
-		NEW_GAME, HIGH_SCORE, QUIT
+		NEW_GAME, SEEDED_GAME, HIGH_SCORE, QUIT
 	};
 
-	const std::string PlayerGuide = "Guide: ↑, →, ↓, ←, q - quit/back, r - restart game, n - new game";
+	const std::string PlayerGuide = "Guide: ↑, →, ↓, ←, q - quit/back, r - restart game, n - new game, h - hint, a - autoplay";
 	const std::string CopyrightInfo = "Copyright (c) 2020 Adrián Kokuľa - adriankokula.eu; License: The MIT License (MIT)";
 	const std::string HighScoreHeader = "High score table";
 	const std::string GameOver = "Game over. No other move is possible!";
+	const std::string SeedPrompt = "Seed (enter - start, q - back):";
+
+	// Digits of seed typed in menu, every such number fits uint64_t
+	const std::size_t MaxSeedDigits = 19;
+
+	// Time for search of hinted move
+	const int HintTimeBudgetMs = 50;
+
+	// Autoplay asks for hint and plays it on every tick of timer with this interval
+	const int AutoplayIntervalMs = 150;
+
+	// Post-game analysis plays out every move of finished game this many times
+	const int AnalysisRollouts = 10;
+
+	// Moves with biggest regret shown after game over
+	const std::size_t BlunderCount = 8;
+
+	const std::string AutoplayLabel = "Autoplay";
+	const std::string AnalyzingLabel = "Analyzing game...";
+	const std::string BlundersLabel = "Blunders:";
+	const std::string NoBlundersLabel = "No blunders";
+
+	struct ColorPair {
+
+		uint8_t Pair;
+		short Foreground;
+		short Background;
+
+	};
+
+	// pairs 1-14 are colors of tiles by exponent, 30 is color of texts
+	const std::vector<ColorPair> ColorPairs {
+		{ 1, COLOR_BLACK, COLOR_RED },
+		{ 2, COLOR_BLACK, COLOR_GREEN },
+		{ 3, COLOR_BLACK, COLOR_YELLOW },
+		{ 4, COLOR_BLACK, COLOR_BLUE },
+		{ 5, COLOR_BLACK, COLOR_MAGENTA },
+		{ 6, COLOR_BLACK, COLOR_CYAN },
+		{ 7, COLOR_BLACK, COLOR_WHITE },
+		{ 8, COLOR_RED, COLOR_BLACK },
+		{ 9, COLOR_RED, COLOR_GREEN },
+		{ 10, COLOR_RED, COLOR_YELLOW },
+		{ 11, COLOR_RED, COLOR_BLUE },
+		{ 12, COLOR_RED, COLOR_MAGENTA },
+		{ 13, COLOR_RED, COLOR_CYAN },
+		{ 14, COLOR_RED, COLOR_WHITE },
+		{ 30, COLOR_GREEN, COLOR_BLACK }
+	};
 
 	const uint8_t TileWidth = 10;
 	const uint8_t TileHeight = 5;
 
 	const std::vector<std::string> MenuOptions {
 		"New game",
+		"Seeded game",
 		"High score",
 		"Quit"
 	};
@@ -68,9 +119,26 @@ namespace Game2048 {
 	void InitColors();
 
 	/// <summary>
-	/// Game loop
+	/// Menu loop of interactive game, inits and deinits ncurses
+	/// </summary>
+	/// <param name="seeded">new game from menu starts from given seed instead of random one</param>
+	/// <param name="seed"></param>
+	/// <returns>process exit code</returns>
+	int RunInteractive(const bool seeded = false, const uint64_t seed = 0);
+
+	/// <summary>
+	/// Game loop, game is determined by its seed and moves. Seed is shown, so any game can be played again.
 	/// </summary>
-	void PlayGame();
+	/// <param name="seeded">restart keeps given seed, otherwise every game gets random seed</param>
+	/// <param name="seed"></param>
+	void PlayGame(const bool seeded, const uint64_t seed);
+
+	/// <summary>
+	/// Lets user type seed of game
+	/// </summary>
+	/// <param name="seed">shown at start, typed seed on return</param>
+	/// <returns>false if user went back</returns>
+	bool AskSeed(uint64_t &seed);
 
 	/// <summary>
 	/// Prints game logo to stdscr
@@ -83,14 +151,14 @@ namespace Game2048 {
 	void ClearScreen();
 
 	/// <summary>
-	/// Prints actuall state of game and high score table
+	/// Print given tile to specific window
 	/// </summary>
-	void PrintGame(WINDOW *gameWindow, WINDOW *highScoreWindow, Game *game, std::vector<uint32_t> *highScores);
+	void PrintTile(WINDOW *gameWindow, const uint8_t row, const uint8_t col, const uint16_t value);
 
 	/// <summary>
-	/// Print given tile to specific window
+	/// Get arrow symbol of given direction
 	/// </summary>
-	void PrintTile(WINDOW *gameWindow, const uint8_t row, const uint8_t col, const uint16_t value);
+	std::string GetDirectionArrow(const Direction direction);
 
 	/// <summary>
 	/// Prints table of high score